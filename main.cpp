@@ -24,24 +24,25 @@ public:
     bool hasData = false;
 
     static std::shared_ptr<Test> create(float width, float height) {
-        std::shared_ptr<Test> test = std::make_shared<Test>();
+        std::shared_ptr<Test> test = Widget::create<Test>();
         test->setSize(width, height);
         test->hasData = true;
         return test;
     }
 
     static std::shared_ptr<Test> create(const WidgetPtr &parent, float x, float y, float width, float height) {
-        std::shared_ptr<Test> test = std::make_shared<Test>();
+        std::shared_ptr<Test> test = Widget::create<Test>();
         test->setRect(x, y, width, height);
         parent->addChild(test);
         return test;
     }
 
     virtual void draw(float px, float py, bool enabled, bool highlighted, bool pushed, bool selected) {
-        al_draw_filled_rectangle(px + getX(), py + getY(), px + getX() + getWidth(), py + getY() + getHeight(), al_map_rgb(255, 255, 255));
-        al_draw_rectangle(px + getX(), py + getY(), px + getX() + getWidth(), py + getY() + getHeight(), al_map_rgb(0, 0, 0), 1);
+        PrimitiveBatch *batch = PrimitiveBatch::getCurrent();
+        batch->drawFilledRectangle(px + getX(), py + getY(), px + getX() + getWidth(), py + getY() + getHeight(), al_map_rgb(255, 255, 255));
+        batch->drawRectangle(px + getX(), py + getY(), px + getX() + getWidth(), py + getY() + getHeight(), al_map_rgb(0, 0, 0), 1);
         if (hasData) {
-            al_draw_filled_rectangle(px + getX(), py + getY(), px + getX() + 16, py + getY() + 16, al_map_rgb(255, 0, 0));
+            batch->drawFilledRectangle(px + getX(), py + getY(), px + getX() + 16, py + getY() + 16, al_map_rgb(255, 0, 0));
         }
         Widget::draw(px, py, enabled, highlighted, pushed, selected);
     }
@@ -117,7 +118,9 @@ public:
         if (test) {
             std::string data = (std::string &)draggedObject;
             test->hasData = false;
+            test->invalidate();
             hasData = true;
+            invalidate();
             return true;
         }
         return false;
@@ -181,6 +184,9 @@ int main()
 
     al_start_timer(timer);
 
+    //the gui is drawn into this bitmap, so as that only the damaged areas need to be redrawn
+    ALLEGRO_BITMAP *buffer = al_create_bitmap(al_get_display_width(display), al_get_display_height(display));
+
     WidgetPtr root = Test::create(al_get_display_width(display), al_get_display_height(display));
     WidgetPtr form1 = Test::create(root, 100, 50, 250, 200);
     WidgetPtr form2 = Test::create(root, 200, 150, 250, 200);
@@ -192,42 +198,58 @@ int main()
 
     Skin skin("skin.txt");
     auto font = skin.getFont("test", "font");
+    cout << "font prewarm: " << skin.getResourceCache().getPrewarmCount() << " characters in " << skin.getResourceCache().getPrewarmTime() * 1000 << " ms\n";
+    auto atlasUsage = skin.getResourceCache().getAtlasUsage();
+    cout << "atlas: " << (skin.getResourceCache().isAtlasEnabled() ? "enabled" : "disabled") << ", " << atlasUsage.size() << " pages\n";
+    for(const ResourceCache::AtlasPageUsage &page : atlasUsage) {
+        cout << "atlas page: " << page.width << 'x' << page.height << ", " << page.bitmapCount << " bitmaps, " << page.usedPixels * 100 / ((size_t)page.width * page.height) << "% used\n";
+    }
     ALLEGRO_COLOR color1 = skin.getColor("test", "color1");
     int size1 = skin.getInt("test", "size1");
     bool flag1 = skin.getBool("test", "flag1");
     Rect dims = skin.getRect("test", "dims");
 
+    //functions posted by other threads are invoked when the root dispatches the events of its post queue
+    al_register_event_source(eventQueue, root->getPostQueue()->getEventSource());
+
+    root->invalidate();
+
     bool loop = true;
+    bool repaint = false;
     while (loop)
     {
-        ALLEGRO_EVENT event;
-        al_wait_for_event(eventQueue, &event);
-        switch (event.type)
-        {
-            case ALLEGRO_EVENT_KEY_DOWN:
-                switch (event.keyboard.keycode)
-                {
-                    case ALLEGRO_KEY_ESCAPE:
+        al_wait_for_event(eventQueue, nullptr);
+        root->dispatchQueue(eventQueue, [&](ALLEGRO_EVENT &event) {
+            switch (event.type)
+            {
+                case ALLEGRO_EVENT_KEY_DOWN:
+                    if (event.keyboard.keycode == ALLEGRO_KEY_ESCAPE) {
                         loop = false;
-                        break;
-
-                    default:
-                        root->dispatch(&event);
-                }
-                break;
-
-            case ALLEGRO_EVENT_TIMER:
-                root->draw();
-                al_flip_display();
-                root->dispatch(&event);
-                break;
-
-            default:
-                root->dispatch(&event);
-                break;
-        }
+                        return true;
+                    }
+                    break;
+
+                case ALLEGRO_EVENT_TIMER:
+                    root->updateLayout();
+                    if (root->hasDamage() || repaint) {
+                        al_set_target_bitmap(buffer);
+                        root->redraw();
+                        al_set_target_backbuffer(display);
+                        al_draw_bitmap(buffer, 0, 0, 0);
+                        al_flip_display();
+                        repaint = false;
+                    }
+                    break;
+
+                case ALLEGRO_EVENT_DISPLAY_EXPOSE:
+                    repaint = true;
+                    return true;
+            }
+            return false;
+        });
     }
 
+    al_destroy_bitmap(buffer);
     al_destroy_timer(timer);
     al_destroy_event_queue(eventQueue);
     al_destroy_display(display);
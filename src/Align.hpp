@@ -0,0 +1,37 @@
+#ifndef AMGUI_ALIGN_HPP
+#define AMGUI_ALIGN_HPP
+
+
+namespace amgui {
+
+
+/**
+    Alignment of a widget within the space its layout container gives it.
+ */
+enum Align {
+    /**
+        Placed at the left or top of the space.
+     */
+    AlignStart,
+
+    /**
+        Placed at the center of the space.
+     */
+    AlignCenter,
+
+    /**
+        Placed at the right or bottom of the space.
+     */
+    AlignEnd,
+
+    /**
+        Resized to fill the space.
+     */
+    AlignStretch
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_ALIGN_HPP
@@ -0,0 +1,264 @@
+#include <algorithm>
+#include "FlexBox.hpp"
+
+
+namespace amgui {
+
+
+/**
+    The constructor.
+    @param direction direction of the box.
+ */
+FlexBox::FlexBox(Direction direction/* = Row*/) :
+    m_direction(direction),
+    m_spacing(0),
+    m_padding(0),
+    m_align(AlignStretch),
+    m_layoutWidth(0),
+    m_layoutHeight(0),
+    m_layoutValid(false)
+{
+}
+
+
+/**
+    Sets the direction of the box.
+ */
+void FlexBox::setDirection(Direction direction) {
+    if (direction == m_direction) return;
+    m_direction = direction;
+    invalidatePack();
+    _invalidateItems();
+}
+
+
+/**
+    Sets the space between children.
+ */
+void FlexBox::setSpacing(float spacing) {
+    if (spacing == m_spacing) return;
+    m_spacing = spacing;
+    invalidatePack();
+    _invalidateItems();
+}
+
+
+/**
+    Sets the space between the children and the edges of the box.
+ */
+void FlexBox::setPadding(float padding) {
+    if (padding == m_padding) return;
+    m_padding = padding;
+    invalidatePack();
+    _invalidateItems();
+}
+
+
+/**
+    Sets the alignment of the children across the direction of the box.
+ */
+void FlexBox::setAlign(Align align) {
+    if (align == m_align) return;
+    m_align = align;
+    _invalidateItems();
+}
+
+
+/**
+    Returns the grow factor of a child; 0 by default.
+ */
+float FlexBox::getGrow(const WidgetPtr &child) const {
+    const _Item *item = _getItem(child.get());
+    return item ? item->grow : 0;
+}
+
+
+/**
+    Sets the grow factor of a child.
+    @param child child; if it is not a child of this, nothing happens.
+    @param grow grow factor; negative values are treated as 0.
+ */
+void FlexBox::setGrow(const WidgetPtr &child, float grow) {
+    _Item *item = _getItem(child.get());
+    if (!item) return;
+    item->grow = std::max(grow, 0.f);
+    _invalidateItems();
+}
+
+
+/**
+    Returns the shrink factor of a child; 0 by default.
+ */
+float FlexBox::getShrink(const WidgetPtr &child) const {
+    const _Item *item = _getItem(child.get());
+    return item ? item->shrink : 0;
+}
+
+
+/**
+    Sets the shrink factor of a child.
+    @param child child; if it is not a child of this, nothing happens.
+    @param shrink shrink factor; negative values are treated as 0.
+ */
+void FlexBox::setShrink(const WidgetPtr &child, float shrink) {
+    _Item *item = _getItem(child.get());
+    if (!item) return;
+    item->shrink = std::max(shrink, 0.f);
+    _invalidateItems();
+}
+
+
+/**
+    Adds a widget as a child, with grow and shrink factors 0.
+    @param widget widget to add as a child.
+    @param childAfter the new child is inserted before this, if it is not null.
+    @return true on success.
+ */
+bool FlexBox::addChild(const WidgetPtr &widget, const WidgetPtr &childAfter/* = nullptr*/) {
+    if (!Widget::addChild(widget, childAfter)) return false;
+    m_items[widget.get()] = _Item{0, 0, widget->getMeasuredWidth(), widget->getMeasuredHeight(), widget->isVisible()};
+    _invalidateItems();
+    return true;
+}
+
+
+/**
+    Removes a child widget.
+ */
+bool FlexBox::removeChild(const WidgetPtr &widget) {
+    if (!Widget::removeChild(widget)) return false;
+    m_items.erase(widget.get());
+    _invalidateItems();
+    return true;
+}
+
+
+/**
+    Measures the box from the measured sizes of its children.
+ */
+void FlexBox::pack() {
+    Widget::pack();
+
+    float length = 0, thickness = 0;
+    size_t count = 0;
+    for(const WidgetPtr &child : getChildren()) {
+        //the layout is computed again only if the measured size or the visibility of a child changed
+        _Item *item = _getItem(child.get());
+        if (item->width != child->getMeasuredWidth() || item->height != child->getMeasuredHeight() || item->visible != child->isVisible()) {
+            item->width = child->getMeasuredWidth();
+            item->height = child->getMeasuredHeight();
+            item->visible = child->isVisible();
+            m_layoutValid = false;
+        }
+        if (!item->visible) continue;
+
+        length += m_direction == Row ? item->width : item->height;
+        thickness = std::max(thickness, m_direction == Row ? item->height : item->width);
+        ++count;
+    }
+
+    length += 2 * m_padding + (count > 1 ? (count - 1) * m_spacing : 0);
+    thickness += 2 * m_padding;
+    if (m_direction == Row) {
+        setMeasuredSize(length, thickness);
+    }
+    else {
+        setMeasuredSize(thickness, length);
+    }
+}
+
+
+/**
+    Places the children in the box.
+ */
+void FlexBox::layout() {
+    //the children need to be placed again only if the size of the box or the items changed
+    if (!m_layoutValid || getWidth() != m_layoutWidth || getHeight() != m_layoutHeight) {
+        m_layoutWidth = getWidth();
+        m_layoutHeight = getHeight();
+        m_layoutValid = true;
+
+        const float length = m_direction == Row ? getWidth() : getHeight();
+        const float thickness = std::max((m_direction == Row ? getHeight() : getWidth()) - 2 * m_padding, 0.f);
+
+        //sum the sizes and factors of the children
+        float basis = 0, grow = 0, shrink = 0;
+        size_t count = 0;
+        for(const WidgetPtr &child : getChildren()) {
+            if (!child->isVisible()) continue;
+            const _Item *item = _getItem(child.get());
+            float size = m_direction == Row ? item->width : item->height;
+            basis += size;
+            grow += item->grow;
+            shrink += item->shrink * size;
+            ++count;
+        }
+
+        //the extra space is given to the children that grow, the missing space is taken from the children that shrink
+        float extra = length - 2 * m_padding - (count > 1 ? (count - 1) * m_spacing : 0) - basis;
+        float growUnit = extra > 0 && grow > 0 ? extra / grow : 0;
+        float shrinkUnit = extra < 0 && shrink > 0 ? extra / shrink : 0;
+
+        //place the children
+        float position = m_padding;
+        for(const WidgetPtr &child : getChildren()) {
+            if (!child->isVisible()) continue;
+            const _Item *item = _getItem(child.get());
+            float size = m_direction == Row ? item->width : item->height;
+            size = std::max(size + item->grow * growUnit + item->shrink * size * shrinkUnit, 0.f);
+
+            float crossSize = m_direction == Row ? item->height : item->width;
+            float crossPosition = m_padding;
+            switch (m_align) {
+                case AlignStart:
+                    break;
+
+                case AlignCenter:
+                    crossPosition += (thickness - crossSize) / 2;
+                    break;
+
+                case AlignEnd:
+                    crossPosition += thickness - crossSize;
+                    break;
+
+                case AlignStretch:
+                    crossSize = thickness;
+                    break;
+            }
+
+            if (m_direction == Row) {
+                child->setRect(position, crossPosition, size, crossSize);
+            }
+            else {
+                child->setRect(crossPosition, position, crossSize, size);
+            }
+            position += size + m_spacing;
+        }
+    }
+
+    Widget::layout();
+}
+
+
+//finds the item of a child
+FlexBox::_Item *FlexBox::_getItem(const Widget *child) {
+    auto it = m_items.find(child);
+    return it != m_items.end() ? &it->second : nullptr;
+}
+
+
+//finds the item of a child
+const FlexBox::_Item *FlexBox::_getItem(const Widget *child) const {
+    auto it = m_items.find(child);
+    return it != m_items.end() ? &it->second : nullptr;
+}
+
+
+//discards the cached layout, and lays out the box again
+void FlexBox::_invalidateItems() {
+    m_layoutValid = false;
+    invalidateLayout();
+}
+
+
+} //namespace amgui
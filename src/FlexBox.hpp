@@ -0,0 +1,177 @@
+#ifndef AMGUI_FLEXBOX_HPP
+#define AMGUI_FLEXBOX_HPP
+
+
+#include "Widget.hpp"
+#include "Align.hpp"
+
+
+namespace amgui {
+
+
+/**
+    Container that places its visible children in a row or a column.
+    Packing measures the box as large as the measured sizes of its children, plus the spacing and padding;
+    the size of the box itself is left to the layout of its parent, or to the application for a top-level box.
+    Layout gives each child its measured size along the direction of the box,
+    plus a share of the extra space proportional to its grow factor,
+    or minus a share of the missing space proportional to its shrink factor and its size.
+    Both take time linear to the number of children.
+    The layout of the children is cached, and computed again only if the size of the box,
+    the measured sizes of the children, or the settings of the box change.
+ */
+class FlexBox : public Widget {
+public:
+    /**
+        Direction of the box.
+     */
+    enum Direction {
+        /**
+            Children are placed from left to right.
+         */
+        Row,
+
+        /**
+            Children are placed from top to bottom.
+         */
+        Column
+    };
+
+    /**
+        The constructor.
+        @param direction direction of the box.
+     */
+    FlexBox(Direction direction = Row);
+
+    /**
+        Returns the direction of the box.
+     */
+    Direction getDirection() const {
+        return m_direction;
+    }
+
+    /**
+        Sets the direction of the box.
+     */
+    void setDirection(Direction direction);
+
+    /**
+        Returns the space between children.
+     */
+    float getSpacing() const {
+        return m_spacing;
+    }
+
+    /**
+        Sets the space between children.
+     */
+    void setSpacing(float spacing);
+
+    /**
+        Returns the space between the children and the edges of the box.
+     */
+    float getPadding() const {
+        return m_padding;
+    }
+
+    /**
+        Sets the space between the children and the edges of the box.
+     */
+    void setPadding(float padding);
+
+    /**
+        Returns the alignment of the children across the direction of the box.
+     */
+    Align getAlign() const {
+        return m_align;
+    }
+
+    /**
+        Sets the alignment of the children across the direction of the box.
+     */
+    void setAlign(Align align);
+
+    /**
+        Returns the grow factor of a child; 0 by default.
+     */
+    float getGrow(const WidgetPtr &child) const;
+
+    /**
+        Sets the grow factor of a child.
+        @param child child; if it is not a child of this, nothing happens.
+        @param grow grow factor; negative values are treated as 0.
+     */
+    void setGrow(const WidgetPtr &child, float grow);
+
+    /**
+        Returns the shrink factor of a child; 0 by default.
+     */
+    float getShrink(const WidgetPtr &child) const;
+
+    /**
+        Sets the shrink factor of a child.
+        @param child child; if it is not a child of this, nothing happens.
+        @param shrink shrink factor; negative values are treated as 0.
+     */
+    void setShrink(const WidgetPtr &child, float shrink);
+
+    /**
+        Adds a widget as a child, with grow and shrink factors 0.
+        @param widget widget to add as a child.
+        @param childAfter the new child is inserted before this, if it is not null.
+        @return true on success.
+     */
+    virtual bool addChild(const WidgetPtr &widget, const WidgetPtr &childAfter = nullptr) override;
+
+    /**
+        Removes a child widget.
+     */
+    virtual bool removeChild(const WidgetPtr &widget) override;
+
+    /**
+        Measures the box from the measured sizes of its children.
+     */
+    virtual void pack() override;
+
+    /**
+        Places the children in the box.
+     */
+    virtual void layout() override;
+
+private:
+    //settings and last measured size of a child
+    struct _Item {
+        float grow;
+        float shrink;
+        float width;
+        float height;
+        bool visible;
+    };
+
+    //settings
+    Direction m_direction;
+    float m_spacing;
+    float m_padding;
+    Align m_align;
+
+    //items of the children
+    std::unordered_map<const Widget *, _Item> m_items;
+
+    //size for which the children were laid out
+    float m_layoutWidth;
+    float m_layoutHeight;
+    bool m_layoutValid;
+
+    //finds the item of a child
+    _Item *_getItem(const Widget *child);
+    const _Item *_getItem(const Widget *child) const;
+
+    //discards the cached layout, and lays out the box again
+    void _invalidateItems();
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_FLEXBOX_HPP
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include "GridBox.hpp"
+
+
+namespace amgui {
+
+
+//distributes extra space to the sizes in proportion to the weights; returns the sizes with the spacing
+static std::vector<float> _distribute(const std::vector<float> &sizes, const std::vector<float> &weights, float length, float spacing) {
+    float total = 0, weight = 0;
+    for(size_t i = 0; i < sizes.size(); ++i) {
+        total += sizes[i];
+        weight += i < weights.size() ? weights[i] : 0;
+    }
+    total += sizes.size() > 1 ? (sizes.size() - 1) * spacing : 0;
+
+    std::vector<float> result(sizes);
+    if (length > total && weight > 0) {
+        float unit = (length - total) / weight;
+        for(size_t i = 0; i < result.size() && i < weights.size(); ++i) {
+            result[i] += weights[i] * unit;
+        }
+    }
+    return result;
+}
+
+
+//places a child of the given measured size within a cell
+static void _align(Align align, float cellPosition, float cellSize, float size, float &position, float &resultSize) {
+    position = cellPosition;
+    resultSize = size;
+    switch (align) {
+        case AlignStart:
+            break;
+
+        case AlignCenter:
+            position += (cellSize - size) / 2;
+            break;
+
+        case AlignEnd:
+            position += cellSize - size;
+            break;
+
+        case AlignStretch:
+            resultSize = cellSize;
+            break;
+    }
+}
+
+
+/**
+    The constructor.
+    @param columns number of columns; at least 1.
+ */
+GridBox::GridBox(size_t columns/* = 1*/) :
+    m_columns(std::max(columns, (size_t)1)),
+    m_spacing(0),
+    m_padding(0),
+    m_align(AlignStretch),
+    m_layoutWidth(0),
+    m_layoutHeight(0),
+    m_layoutValid(false)
+{
+}
+
+
+/**
+    Sets the number of columns.
+    @param columns number of columns; at least 1.
+ */
+void GridBox::setColumns(size_t columns) {
+    columns = std::max(columns, (size_t)1);
+    if (columns == m_columns) return;
+    m_columns = columns;
+    invalidatePack();
+    _invalidateCells();
+}
+
+
+/**
+    Sets the space between cells.
+ */
+void GridBox::setSpacing(float spacing) {
+    if (spacing == m_spacing) return;
+    m_spacing = spacing;
+    invalidatePack();
+    _invalidateCells();
+}
+
+
+/**
+    Sets the space between the cells and the edges of the box.
+ */
+void GridBox::setPadding(float padding) {
+    if (padding == m_padding) return;
+    m_padding = padding;
+    invalidatePack();
+    _invalidateCells();
+}
+
+
+/**
+    Sets the alignment of the children within their cells.
+ */
+void GridBox::setAlign(Align align) {
+    if (align == m_align) return;
+    m_align = align;
+    _invalidateCells();
+}
+
+
+/**
+    Returns the weight of a column; 0 by default.
+ */
+float GridBox::getColumnWeight(size_t column) const {
+    return column < m_columnWeights.size() ? m_columnWeights[column] : 0;
+}
+
+
+/**
+    Sets the weight of a column.
+    @param column index of the column.
+    @param weight weight; negative values are treated as 0.
+ */
+void GridBox::setColumnWeight(size_t column, float weight) {
+    if (column >= m_columnWeights.size()) {
+        m_columnWeights.resize(column + 1, 0);
+    }
+    m_columnWeights[column] = std::max(weight, 0.f);
+    _invalidateCells();
+}
+
+
+/**
+    Returns the weight of a row; 0 by default.
+ */
+float GridBox::getRowWeight(size_t row) const {
+    return row < m_rowWeights.size() ? m_rowWeights[row] : 0;
+}
+
+
+/**
+    Sets the weight of a row.
+    @param row index of the row.
+    @param weight weight; negative values are treated as 0.
+ */
+void GridBox::setRowWeight(size_t row, float weight) {
+    if (row >= m_rowWeights.size()) {
+        m_rowWeights.resize(row + 1, 0);
+    }
+    m_rowWeights[row] = std::max(weight, 0.f);
+    _invalidateCells();
+}
+
+
+/**
+    Adds a widget as a child.
+    @param widget widget to add as a child.
+    @param childAfter the new child is inserted before this, if it is not null.
+    @return true on success.
+ */
+bool GridBox::addChild(const WidgetPtr &widget, const WidgetPtr &childAfter/* = nullptr*/) {
+    if (!Widget::addChild(widget, childAfter)) return false;
+    _invalidateCells();
+    return true;
+}
+
+
+/**
+    Removes a child widget.
+ */
+bool GridBox::removeChild(const WidgetPtr &widget) {
+    if (!Widget::removeChild(widget)) return false;
+
+    //the cells may no longer be compared to the current children, since a new child may take the address of the removed one
+    m_cells.clear();
+    _invalidateCells();
+    return true;
+}
+
+
+/**
+    Measures the box from the measured sizes of its children.
+ */
+void GridBox::pack() {
+    Widget::pack();
+
+    //measure the columns and rows
+    std::vector<_Cell> cells;
+    std::vector<float> columnSizes, rowSizes;
+    for(const WidgetPtr &child : getChildren()) {
+        if (!child->isVisible()) continue;
+        size_t column = cells.size() % m_columns;
+        if (column >= columnSizes.size()) {
+            columnSizes.push_back(0);
+        }
+        if (column == 0) {
+            rowSizes.push_back(0);
+        }
+        columnSizes[column] = std::max(columnSizes[column], child->getMeasuredWidth());
+        rowSizes.back() = std::max(rowSizes.back(), child->getMeasuredHeight());
+        cells.push_back({child.get(), child->getMeasuredWidth(), child->getMeasuredHeight()});
+    }
+
+    //the layout is computed again only if the cells or their sizes changed;
+    //the size of a cell matters even if the sizes of its column and row do not change, since an aligned child gets its measured size
+    if (cells != m_cells || columnSizes != m_columnSizes || rowSizes != m_rowSizes) {
+        m_cells.swap(cells);
+        m_columnSizes.swap(columnSizes);
+        m_rowSizes.swap(rowSizes);
+        m_layoutValid = false;
+    }
+
+    float width = 2 * m_padding, height = 2 * m_padding;
+    for(float size : m_columnSizes) {
+        width += size;
+    }
+    for(float size : m_rowSizes) {
+        height += size;
+    }
+    width += m_columnSizes.size() > 1 ? (m_columnSizes.size() - 1) * m_spacing : 0;
+    height += m_rowSizes.size() > 1 ? (m_rowSizes.size() - 1) * m_spacing : 0;
+    setMeasuredSize(width, height);
+}
+
+
+/**
+    Places the children in the cells of the box.
+ */
+void GridBox::layout() {
+    //the children need to be placed again only if the size of the box or the cells changed
+    if (!m_layoutValid || getWidth() != m_layoutWidth || getHeight() != m_layoutHeight) {
+        m_layoutWidth = getWidth();
+        m_layoutHeight = getHeight();
+        m_layoutValid = true;
+
+        std::vector<float> columnSizes = _distribute(m_columnSizes, m_columnWeights, getWidth() - 2 * m_padding, m_spacing);
+        std::vector<float> rowSizes = _distribute(m_rowSizes, m_rowWeights, getHeight() - 2 * m_padding, m_spacing);
+
+        //place the children, row by row
+        size_t index = 0;
+        float cellX = m_padding, cellY = m_padding;
+        for(const WidgetPtr &child : getChildren()) {
+            if (!child->isVisible()) continue;
+            size_t column = index % m_columns, row = index / m_columns;
+            if (column == 0 && row > 0) {
+                cellX = m_padding;
+                cellY += rowSizes[row - 1] + m_spacing;
+            }
+
+            float x, y, width, height;
+            _align(m_align, cellX, columnSizes[column], child->getMeasuredWidth(), x, width);
+            _align(m_align, cellY, rowSizes[row], child->getMeasuredHeight(), y, height);
+            child->setRect(x, y, width, height);
+
+            cellX += columnSizes[column] + m_spacing;
+            ++index;
+        }
+    }
+
+    Widget::layout();
+}
+
+
+//discards the cached layout, and lays out the box again
+void GridBox::_invalidateCells() {
+    m_layoutValid = false;
+    invalidateLayout();
+}
+
+
+} //namespace amgui
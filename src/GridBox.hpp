@@ -0,0 +1,163 @@
+#ifndef AMGUI_GRIDBOX_HPP
+#define AMGUI_GRIDBOX_HPP
+
+
+#include "Widget.hpp"
+#include "Align.hpp"
+
+
+namespace amgui {
+
+
+/**
+    Container that places its visible children in the cells of a grid, row by row.
+    Packing measures each column as wide as its widest child, and each row as tall as its tallest child;
+    the size of the box itself is left to the layout of its parent, or to the application for a top-level box.
+    Layout distributes the extra space of the box to the columns and rows in proportion to their weights.
+    Both take time linear to the number of children.
+    The layout of the children is cached, and computed again only if the size of the box,
+    the measured sizes of the children, or the settings of the box change.
+ */
+class GridBox : public Widget {
+public:
+    /**
+        The constructor.
+        @param columns number of columns; at least 1.
+     */
+    GridBox(size_t columns = 1);
+
+    /**
+        Returns the number of columns.
+     */
+    size_t getColumns() const {
+        return m_columns;
+    }
+
+    /**
+        Sets the number of columns.
+        @param columns number of columns; at least 1.
+     */
+    void setColumns(size_t columns);
+
+    /**
+        Returns the space between cells.
+     */
+    float getSpacing() const {
+        return m_spacing;
+    }
+
+    /**
+        Sets the space between cells.
+     */
+    void setSpacing(float spacing);
+
+    /**
+        Returns the space between the cells and the edges of the box.
+     */
+    float getPadding() const {
+        return m_padding;
+    }
+
+    /**
+        Sets the space between the cells and the edges of the box.
+     */
+    void setPadding(float padding);
+
+    /**
+        Returns the alignment of the children within their cells.
+     */
+    Align getAlign() const {
+        return m_align;
+    }
+
+    /**
+        Sets the alignment of the children within their cells.
+     */
+    void setAlign(Align align);
+
+    /**
+        Returns the weight of a column; 0 by default.
+     */
+    float getColumnWeight(size_t column) const;
+
+    /**
+        Sets the weight of a column.
+        @param column index of the column.
+        @param weight weight; negative values are treated as 0.
+     */
+    void setColumnWeight(size_t column, float weight);
+
+    /**
+        Returns the weight of a row; 0 by default.
+     */
+    float getRowWeight(size_t row) const;
+
+    /**
+        Sets the weight of a row.
+        @param row index of the row.
+        @param weight weight; negative values are treated as 0.
+     */
+    void setRowWeight(size_t row, float weight);
+
+    /**
+        Adds a widget as a child.
+        @param widget widget to add as a child.
+        @param childAfter the new child is inserted before this, if it is not null.
+        @return true on success.
+     */
+    virtual bool addChild(const WidgetPtr &widget, const WidgetPtr &childAfter = nullptr) override;
+
+    /**
+        Removes a child widget.
+     */
+    virtual bool removeChild(const WidgetPtr &widget) override;
+
+    /**
+        Measures the box from the measured sizes of its children.
+     */
+    virtual void pack() override;
+
+    /**
+        Places the children in the cells of the box.
+     */
+    virtual void layout() override;
+
+private:
+    //visible child and its size, as last measured
+    struct _Cell {
+        const Widget *widget;
+        float width;
+        float height;
+
+        bool operator == (const _Cell &cell) const {
+            return widget == cell.widget && width == cell.width && height == cell.height;
+        }
+    };
+
+    //settings
+    size_t m_columns;
+    float m_spacing;
+    float m_padding;
+    Align m_align;
+    std::vector<float> m_columnWeights;
+    std::vector<float> m_rowWeights;
+
+    //visible children, and sizes of columns and rows, as last measured
+    std::vector<_Cell> m_cells;
+    std::vector<float> m_columnSizes;
+    std::vector<float> m_rowSizes;
+
+    //size for which the children were laid out
+    float m_layoutWidth;
+    float m_layoutHeight;
+    bool m_layoutValid;
+
+    //discards the cached layout, and lays out the box again
+    void _invalidateCells();
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_GRIDBOX_HPP
@@ -0,0 +1,212 @@
+#include <cmath>
+#include <algorithm>
+#include "ListView.hpp"
+
+
+namespace amgui {
+
+
+//default pixels per wheel step
+static const float _defaultWheelStep = 48;
+
+
+//value returned for invalid row indexes
+const size_t ListView::npos;
+
+
+/**
+    The constructor.
+ */
+ListView::ListView() :
+    m_scrollPosition(0),
+    m_wheelStep(_defaultWheelStep)
+{
+    //rows partially scrolled out must not be drawn outside of the list
+    setClipChildren(true);
+
+    //the layout calls the data source, which need not be thread-safe, and creates and removes rows
+    setSerialLayout(true);
+}
+
+
+/**
+    Sets the data source.
+    @param dataSource data source; it may be null.
+ */
+void ListView::setDataSource(const std::shared_ptr<ListDataSource> &dataSource) {
+    if (dataSource == m_dataSource) return;
+    _removeRows();
+    m_dataSource = dataSource;
+    m_scrollPosition = 0;
+    invalidateLayout();
+}
+
+
+/**
+    Sets the vertical scroll position.
+    @param position position, in pixels from the top of the first row.
+ */
+void ListView::setScrollPosition(double position) {
+    position = std::max(std::min(position, _getContentHeight() - getHeight()), 0.0);
+    if (position == m_scrollPosition) return;
+    m_scrollPosition = position;
+    invalidateLayout();
+}
+
+
+/**
+    Scrolls the least needed for the given row to be entirely visible.
+    @param row index of the row.
+ */
+void ListView::scrollToRow(size_t row) {
+    if (!m_dataSource || row >= m_dataSource->getRowCount()) return;
+    double top = row * (double)m_dataSource->getRowHeight();
+    double bottom = top + m_dataSource->getRowHeight();
+    if (top < m_scrollPosition) {
+        setScrollPosition(top);
+    }
+    else if (bottom > m_scrollPosition + getHeight()) {
+        setScrollPosition(bottom - getHeight());
+    }
+}
+
+
+/**
+    Returns the index of the first visible row, or npos if there are no rows.
+ */
+size_t ListView::getFirstVisibleRow() const {
+    return rowFromPoint(0);
+}
+
+
+/**
+    Returns the row at the given point, or npos if there is no row at that point.
+    @param y y coordinate, relative to the list.
+ */
+size_t ListView::rowFromPoint(float y) const {
+    if (!m_dataSource || m_dataSource->getRowHeight() <= 0 || y < 0 || y >= getHeight()) return npos;
+    double row = std::floor((m_scrollPosition + y) / m_dataSource->getRowHeight());
+    return row < m_dataSource->getRowCount() ? (size_t)row : npos;
+}
+
+
+/**
+    Returns the widget bound to the given row, or null if the row is not visible.
+ */
+WidgetPtr ListView::getRowWidget(size_t row) const {
+    if (m_rows.empty()) return nullptr;
+    const _Row &entry = m_rows[row % m_rows.size()];
+    return entry.row == row ? entry.widget : nullptr;
+}
+
+
+/**
+    Binds the visible rows again, and adjusts to the new number of rows.
+ */
+void ListView::reloadRows() {
+    for(_Row &entry : m_rows) {
+        entry.row = npos;
+    }
+    invalidateLayout();
+}
+
+
+/**
+    Binds the given rows again, if they are visible.
+    @param first index of the first row.
+    @param count number of rows.
+ */
+void ListView::reloadRows(size_t first, size_t count) {
+    for(_Row &entry : m_rows) {
+        if (entry.row != npos && entry.row >= first && entry.row - first < count) {
+            entry.row = npos;
+            invalidateLayout();
+        }
+    }
+}
+
+
+/**
+    Scrolls the list, unless a child processes the event.
+ */
+bool ListView::mouseWheel(int z, int w) {
+    if (Widget::mouseWheel(z, w)) return true;
+    if (!getMouseWheelDeltaZ()) return false;
+    setScrollPosition(m_scrollPosition - getMouseWheelDeltaZ() * m_wheelStep);
+    return true;
+}
+
+
+/**
+    Creates the row widgets needed to fill the list, binds them to the visible rows, and places them.
+ */
+void ListView::layout() {
+    const float rowHeight = m_dataSource ? m_dataSource->getRowHeight() : 0;
+    const size_t rowCount = m_dataSource && rowHeight > 0 ? m_dataSource->getRowCount() : 0;
+
+    //the number of rows may have changed, or the list may have been resized
+    m_scrollPosition = std::max(std::min(m_scrollPosition, _getContentHeight() - getHeight()), 0.0);
+
+    //enough widgets for a partially visible row at the top and at the bottom
+    size_t needed = rowCount ? std::min(rowCount, (size_t)std::ceil(getHeight() / rowHeight) + 1) : 0;
+    if (needed != m_rows.size()) {
+        while (m_rows.size() > needed) {
+            removeChild(m_rows.back().widget);
+            m_rows.pop_back();
+        }
+        while (m_rows.size() < needed) {
+            WidgetPtr widget = m_dataSource->createRow();
+            if (!widget || !addChild(widget)) break;
+            m_rows.push_back(_Row{widget, npos});
+        }
+
+        //with another number of widgets, the rows map to other widgets
+        for(_Row &entry : m_rows) {
+            entry.row = npos;
+        }
+    }
+
+    //bind the widgets of the rows which came into view, and place all the visible ones
+    if (!m_rows.empty()) {
+        const size_t first = (size_t)(m_scrollPosition / rowHeight);
+        const size_t end = std::min(first + m_rows.size(), rowCount);
+        for(size_t row = first; row < end; ++row) {
+            _Row &entry = m_rows[row % m_rows.size()];
+            //the new content of the widget is packed and laid out right away, so as that it shows in this frame
+            if (entry.row != row) {
+                entry.row = row;
+                m_dataSource->bindRow(row, entry.widget);
+                entry.widget->updateLayout();
+            }
+            entry.widget->setRect(0, (float)(row * (double)rowHeight - m_scrollPosition), getWidth(), rowHeight);
+            entry.widget->setVisible(true);
+        }
+
+        //the widgets left over at the end of the rows are hidden
+        for(size_t i = end - first; i < m_rows.size(); ++i) {
+            _Row &entry = m_rows[(first + i) % m_rows.size()];
+            entry.row = npos;
+            entry.widget->setVisible(false);
+        }
+    }
+
+    Widget::layout();
+}
+
+
+//returns the height of all the rows
+double ListView::_getContentHeight() const {
+    return m_dataSource ? m_dataSource->getRowCount() * (double)m_dataSource->getRowHeight() : 0;
+}
+
+
+//removes the row widgets
+void ListView::_removeRows() {
+    for(_Row &entry : m_rows) {
+        removeChild(entry.widget);
+    }
+    m_rows.clear();
+}
+
+
+} //namespace amgui
@@ -0,0 +1,183 @@
+#ifndef AMGUI_LISTVIEW_HPP
+#define AMGUI_LISTVIEW_HPP
+
+
+#include "Widget.hpp"
+
+
+namespace amgui {
+
+
+/**
+    Interface of the data shown by a list view.
+ */
+class ListDataSource {
+public:
+    /**
+        The destructor.
+     */
+    virtual ~ListDataSource() {
+    }
+
+    /**
+        Returns the number of rows.
+     */
+    virtual size_t getRowCount() const = 0;
+
+    /**
+        Returns the height of the rows; all rows have the same height.
+     */
+    virtual float getRowHeight() const = 0;
+
+    /**
+        Creates a widget for showing rows.
+        The list view creates only as many as it needs to fill its height, and reuses them for other rows as it scrolls.
+     */
+    virtual WidgetPtr createRow() = 0;
+
+    /**
+        Sets up a widget created by createRow() to show the given row.
+        @param row index of the row.
+        @param widget widget to set up.
+     */
+    virtual void bindRow(size_t row, const WidgetPtr &widget) = 0;
+};
+
+
+/**
+    Vertical list of rows that creates widgets only for the rows it shows.
+    The rows are provided by a data source; each row widget is bound to a row as the row scrolls into view,
+    so the cost of layout and scrolling depends on the number of visible rows, not on the number of rows.
+ */
+class ListView : public Widget {
+public:
+    /**
+        Value returned for invalid row indexes.
+     */
+    static const size_t npos = (size_t)-1;
+
+    /**
+        The constructor.
+     */
+    ListView();
+
+    /**
+        Returns the data source.
+     */
+    const std::shared_ptr<ListDataSource> &getDataSource() const {
+        return m_dataSource;
+    }
+
+    /**
+        Sets the data source.
+        The row widgets of the previous data source are removed.
+        @param dataSource data source; it may be null.
+     */
+    void setDataSource(const std::shared_ptr<ListDataSource> &dataSource);
+
+    /**
+        Returns the vertical scroll position, in pixels from the top of the first row.
+     */
+    double getScrollPosition() const {
+        return m_scrollPosition;
+    }
+
+    /**
+        Sets the vertical scroll position.
+        The row widgets are bound to the rows that come into view by the next layout pass.
+        @param position position, in pixels from the top of the first row;
+            it is limited to the range from 0 to the height of the rows minus the height of the list.
+     */
+    void setScrollPosition(double position);
+
+    /**
+        Scrolls the least needed for the given row to be entirely visible.
+        @param row index of the row.
+     */
+    void scrollToRow(size_t row);
+
+    /**
+        Returns the number of pixels scrolled for each step of the mouse wheel.
+     */
+    float getWheelStep() const {
+        return m_wheelStep;
+    }
+
+    /**
+        Sets the number of pixels scrolled for each step of the mouse wheel.
+     */
+    void setWheelStep(float step) {
+        m_wheelStep = step;
+    }
+
+    /**
+        Returns the index of the first visible row, or npos if there are no rows.
+     */
+    size_t getFirstVisibleRow() const;
+
+    /**
+        Returns the row at the given point, or npos if there is no row at that point.
+        @param y y coordinate, relative to the list.
+     */
+    size_t rowFromPoint(float y) const;
+
+    /**
+        Returns the widget bound to the given row, or null if the row is not visible.
+     */
+    WidgetPtr getRowWidget(size_t row) const;
+
+    /**
+        Binds the visible rows again, and adjusts to the new number of rows.
+        It must be called when the data change.
+     */
+    void reloadRows();
+
+    /**
+        Binds the given rows again, if they are visible.
+        @param first index of the first row.
+        @param count number of rows.
+     */
+    void reloadRows(size_t first, size_t count);
+
+    /**
+        Scrolls the list, unless a child processes the event.
+     */
+    virtual bool mouseWheel(int z, int w) override;
+
+    /**
+        Creates the row widgets needed to fill the list, binds them to the visible rows, and places them.
+     */
+    virtual void layout() override;
+
+private:
+    //row widget and the row it is bound to
+    struct _Row {
+        WidgetPtr widget;
+        size_t row;
+    };
+
+    //data source
+    std::shared_ptr<ListDataSource> m_dataSource;
+
+    //scroll position
+    double m_scrollPosition;
+
+    //pixels per wheel step
+    float m_wheelStep;
+
+    //row widgets; the widget of row r is the one at index r modulo their number,
+    //so as that scrolling rebinds only the widgets of the rows which come into view
+    std::vector<_Row> m_rows;
+
+    //returns the height of all the rows
+    double _getContentHeight() const;
+
+    //removes the row widgets
+    void _removeRows();
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_LISTVIEW_HPP
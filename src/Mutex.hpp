@@ -0,0 +1,113 @@
+#ifndef AMGUI_MUTEX_HPP
+#define AMGUI_MUTEX_HPP
+
+
+#include <allegro5/allegro.h>
+
+
+namespace amgui {
+
+
+/**
+    A mutex, based on the allegro mutex.
+    The standard library threads are not available with the mingw toolchain allegro 5.0 is built with,
+    so the library uses allegro's threads, mutexes and condition variables instead.
+ */
+class Mutex {
+public:
+    /**
+        The constructor.
+     */
+    Mutex() : m_mutex(al_create_mutex()) {
+    }
+
+    /**
+        The copy constructor is deleted.
+     */
+    Mutex(const Mutex &mutex) = delete;
+
+    /**
+        The destructor.
+     */
+    ~Mutex() {
+        al_destroy_mutex(m_mutex);
+    }
+
+    /**
+        The copy assignment is deleted.
+     */
+    Mutex &operator = (const Mutex &mutex) = delete;
+
+    /**
+        Locks the mutex; it is not recursive.
+     */
+    void lock() {
+        al_lock_mutex(m_mutex);
+    }
+
+    /**
+        Unlocks the mutex.
+     */
+    void unlock() {
+        al_unlock_mutex(m_mutex);
+    }
+
+    /**
+        Returns the allegro mutex, as needed by al_wait_cond.
+     */
+    ALLEGRO_MUTEX *get() const {
+        return m_mutex;
+    }
+
+private:
+    ALLEGRO_MUTEX *m_mutex;
+};
+
+
+/**
+    Keeps a mutex locked for as long as it exists.
+ */
+class MutexLock {
+public:
+    /**
+        The constructor.
+        @param mutex mutex to lock; if null, nothing is locked.
+     */
+    MutexLock(Mutex *mutex) : m_mutex(mutex) {
+        if (m_mutex) m_mutex->lock();
+    }
+
+    /**
+        The constructor.
+        @param mutex mutex to lock.
+     */
+    MutexLock(Mutex &mutex) : MutexLock(&mutex) {
+    }
+
+    /**
+        The copy constructor is deleted.
+     */
+    MutexLock(const MutexLock &lock) = delete;
+
+    /**
+        The destructor.
+        Unlocks the mutex.
+     */
+    ~MutexLock() {
+        if (m_mutex) m_mutex->unlock();
+    }
+
+    /**
+        The copy assignment is deleted.
+     */
+    MutexLock &operator = (const MutexLock &lock) = delete;
+
+private:
+    Mutex *m_mutex;
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_MUTEX_HPP
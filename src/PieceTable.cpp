@@ -0,0 +1,351 @@
+#include <algorithm>
+#include "PieceTable.hpp"
+
+
+namespace amgui {
+
+
+//constants used by reference
+const uint32_t PieceTable::_nil;
+
+
+//appends the offsets of the new lines of the given text to the given index
+static void _indexNewlines(const std::string &text, size_t offset, std::vector<size_t> &newlines) {
+    for(size_t pos = text.find('\n'); pos != std::string::npos; pos = text.find('\n', pos + 1)) {
+        newlines.push_back(offset + pos);
+    }
+}
+
+
+/**
+    The constructor.
+    @param text the original text.
+ */
+PieceTable::PieceTable(const std::string &text/* = std::string()*/) :
+    m_free(_nil),
+    m_root(_nil),
+    m_pieceCount(0),
+    m_random(0x9e3779b9)
+{
+    setText(text);
+}
+
+
+/**
+    Returns part of the text.
+    @param offset offset of the part.
+    @param length length of the part; it is limited to the end of the text.
+ */
+std::string PieceTable::getText(size_t offset, size_t length) const {
+    std::string result;
+    if (offset >= size()) return result;
+    length = std::min(length, size() - offset);
+    result.reserve(length);
+    _collect(m_root, offset, length, result);
+    return result;
+}
+
+
+/**
+    Returns the byte at the given offset.
+ */
+char PieceTable::getChar(size_t offset) const {
+    for(uint32_t node = m_root; node != _nil; ) {
+        const _Node &n = m_nodes[node];
+        size_t leftLength = _getLength(n.left);
+        if (offset < leftLength) {
+            node = n.left;
+        }
+        else if (offset < leftLength + n.length) {
+            return _getBuffer(n)[n.start + offset - leftLength];
+        }
+        else {
+            offset -= leftLength + n.length;
+            node = n.right;
+        }
+    }
+    return 0;
+}
+
+
+/**
+    Replaces the text, and clears the buffer of added text.
+ */
+void PieceTable::setText(const std::string &text) {
+    m_original = text;
+    m_added.clear();
+    m_originalNewlines.clear();
+    m_addedNewlines.clear();
+    _indexNewlines(m_original, 0, m_originalNewlines);
+    m_nodes.clear();
+    m_free = _nil;
+    m_root = _nil;
+    m_pieceCount = 0;
+    if (!text.empty()) {
+        m_root = _create(false, 0, text.size(), m_random);
+    }
+}
+
+
+/**
+    Inserts text.
+    @param offset offset to insert the text at; it is limited to the end of the text.
+    @param text text to insert.
+ */
+void PieceTable::insert(size_t offset, const std::string &text) {
+    if (text.empty()) return;
+    offset = std::min(offset, size());
+
+    //the text is appended to the added buffer
+    size_t start = m_added.size();
+    m_added += text;
+    size_t newlineCount = m_addedNewlines.size();
+    _indexNewlines(text, start, m_addedNewlines);
+    size_t newlines = m_addedNewlines.size() - newlineCount;
+
+    uint32_t left, right;
+    _split(m_root, offset, left, right);
+
+    //typing continues the piece of the previous insertion, so as that it does not add a piece per character
+    if (!_extendLast(left, start, text.size(), newlines)) {
+        m_random ^= m_random << 13;
+        m_random ^= m_random >> 17;
+        m_random ^= m_random << 5;
+        left = _merge(left, _create(true, start, text.size(), m_random));
+    }
+
+    m_root = _merge(left, right);
+}
+
+
+/**
+    Erases text.
+    @param offset offset of the text to erase.
+    @param length length of the text to erase; it is limited to the end of the text.
+ */
+void PieceTable::erase(size_t offset, size_t length) {
+    if (offset >= size() || length == 0) return;
+    uint32_t left, middle, right;
+    _split(m_root, offset, left, right);
+    _split(right, length, middle, right);
+    _destroy(middle);
+    m_root = _merge(left, right);
+}
+
+
+/**
+    Returns the offset of the start of a line.
+ */
+size_t PieceTable::getLineStart(size_t line) const {
+    if (line == 0) return 0;
+
+    //find the piece with the new line that ends the previous line
+    size_t offset = 0;
+    for(uint32_t node = m_root; node != _nil; ) {
+        const _Node &n = m_nodes[node];
+        size_t leftNewlines = _getNewlines(n.left);
+        if (line <= leftNewlines) {
+            node = n.left;
+        }
+        else if (line <= leftNewlines + n.newlines) {
+            const std::vector<size_t> &newlines = _getBufferNewlines(n.added);
+            size_t first = std::lower_bound(newlines.begin(), newlines.end(), n.start) - newlines.begin();
+            return offset + _getLength(n.left) + newlines[first + line - leftNewlines - 1] - n.start + 1;
+        }
+        else {
+            line -= leftNewlines + n.newlines;
+            offset += _getLength(n.left) + n.length;
+            node = n.right;
+        }
+    }
+    return size();
+}
+
+
+/**
+    Returns the line the given offset is in.
+ */
+size_t PieceTable::getLineAt(size_t offset) const {
+    //count the new lines before the offset
+    size_t line = 0;
+    for(uint32_t node = m_root; node != _nil; ) {
+        const _Node &n = m_nodes[node];
+        size_t leftLength = _getLength(n.left);
+        if (offset < leftLength) {
+            node = n.left;
+        }
+        else if (offset < leftLength + n.length) {
+            return line + _getNewlines(n.left) + _countNewlines(n.added, n.start, offset - leftLength);
+        }
+        else {
+            line += _getNewlines(n.left) + n.newlines;
+            offset -= leftLength + n.length;
+            node = n.right;
+        }
+    }
+    return line;
+}
+
+
+//counts the new lines of part of a buffer
+size_t PieceTable::_countNewlines(bool added, size_t start, size_t length) const {
+    const std::vector<size_t> &newlines = _getBufferNewlines(added);
+    return std::lower_bound(newlines.begin(), newlines.end(), start + length) - std::lower_bound(newlines.begin(), newlines.end(), start);
+}
+
+
+//creates a node
+uint32_t PieceTable::_create(bool added, size_t start, size_t length, uint32_t priority) {
+    uint32_t node;
+    if (m_free != _nil) {
+        node = m_free;
+        m_free = m_nodes[node].left;
+    }
+    else {
+        node = (uint32_t)m_nodes.size();
+        m_nodes.push_back(_Node());
+    }
+    size_t newlines = _countNewlines(added, start, length);
+    m_nodes[node] = _Node{_nil, _nil, priority, added, start, length, newlines, length, newlines};
+    ++m_pieceCount;
+    return node;
+}
+
+
+//frees the nodes of a subtree
+void PieceTable::_destroy(uint32_t node) {
+    std::vector<uint32_t> stack;
+    if (node != _nil) {
+        stack.push_back(node);
+    }
+    while (!stack.empty()) {
+        node = stack.back();
+        stack.pop_back();
+        _Node &n = m_nodes[node];
+        if (n.left != _nil) {
+            stack.push_back(n.left);
+        }
+        if (n.right != _nil) {
+            stack.push_back(n.right);
+        }
+        n.left = m_free;
+        m_free = node;
+        --m_pieceCount;
+    }
+}
+
+
+//computes the length and new lines of a subtree from its children
+void PieceTable::_update(uint32_t node) {
+    _Node &n = m_nodes[node];
+    n.subtreeLength = _getLength(n.left) + n.length + _getLength(n.right);
+    n.subtreeNewlines = _getNewlines(n.left) + n.newlines + _getNewlines(n.right);
+}
+
+
+//joins two trees; all pieces of the first are before those of the second
+uint32_t PieceTable::_merge(uint32_t left, uint32_t right) {
+    if (left == _nil) return right;
+    if (right == _nil) return left;
+    if (m_nodes[left].priority >= m_nodes[right].priority) {
+        uint32_t child = _merge(m_nodes[left].right, right);
+        m_nodes[left].right = child;
+        _update(left);
+        return left;
+    }
+    uint32_t child = _merge(left, m_nodes[right].left);
+    m_nodes[right].left = child;
+    _update(right);
+    return right;
+}
+
+
+//splits a tree at the given offset, splitting the piece at that offset if needed
+void PieceTable::_split(uint32_t node, size_t offset, uint32_t &left, uint32_t &right) {
+    if (node == _nil) {
+        left = right = _nil;
+        return;
+    }
+
+    size_t leftLength = _getLength(m_nodes[node].left);
+    if (offset <= leftLength) {
+        uint32_t child;
+        _split(m_nodes[node].left, offset, left, child);
+        m_nodes[node].left = child;
+        _update(node);
+        right = node;
+    }
+    else if (offset >= leftLength + m_nodes[node].length) {
+        uint32_t child;
+        _split(m_nodes[node].right, offset - leftLength - m_nodes[node].length, child, right);
+        m_nodes[node].right = child;
+        _update(node);
+        left = node;
+    }
+    else {
+        //the end of the piece goes to a new node, which takes the right subtree;
+        //it has the same priority, so as that it can be the root of that subtree
+        size_t length = offset - leftLength;
+        _Node n = m_nodes[node];
+        uint32_t tail = _create(n.added, n.start + length, n.length - length, n.priority);
+        m_nodes[tail].right = n.right;
+        _update(tail);
+        m_nodes[node].right = _nil;
+        m_nodes[node].length = length;
+        m_nodes[node].newlines = n.newlines - m_nodes[tail].newlines;
+        _update(node);
+        left = node;
+        right = tail;
+    }
+}
+
+
+//extends the last piece of a tree by the given length of text, if it ends at the end of the added buffer
+bool PieceTable::_extendLast(uint32_t node, size_t end, size_t length, size_t newlines) {
+    if (node == _nil) return false;
+    _Node &n = m_nodes[node];
+    if (n.right != _nil) {
+        if (!_extendLast(n.right, end, length, newlines)) return false;
+    }
+    else if (n.added && n.start + n.length == end) {
+        n.length += length;
+        n.newlines += newlines;
+    }
+    else {
+        return false;
+    }
+    _update(node);
+    return true;
+}
+
+
+//appends part of a subtree to a string
+void PieceTable::_collect(uint32_t node, size_t offset, size_t length, std::string &result) const {
+    while (node != _nil && length > 0) {
+        const _Node &n = m_nodes[node];
+        size_t leftLength = _getLength(n.left);
+
+        //part of the left subtree
+        if (offset < leftLength) {
+            size_t count = std::min(length, leftLength - offset);
+            _collect(n.left, offset, count, result);
+            offset = leftLength;
+            length -= count;
+        }
+
+        //part of the piece
+        if (length > 0 && offset < leftLength + n.length) {
+            size_t count = std::min(length, leftLength + n.length - offset);
+            result.append(_getBuffer(n), n.start + offset - leftLength, count);
+            offset = leftLength + n.length;
+            length -= count;
+        }
+
+        //part of the right subtree
+        offset -= leftLength + n.length;
+        node = n.right;
+    }
+}
+
+
+} //namespace amgui
@@ -0,0 +1,197 @@
+#ifndef AMGUI_PIECETABLE_HPP
+#define AMGUI_PIECETABLE_HPP
+
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace amgui {
+
+
+/**
+    Text stored as pieces of two buffers: the original text, and the text added by edits, which is only appended to.
+    The pieces are kept in a balanced tree, ordered by their position in the text;
+    each subtree knows its length and its number of new lines,
+    so inserting, erasing, and finding an offset or a line take O(log n) time, regardless of the size of the text.
+    The new lines of each buffer are indexed as the buffer grows, so the line index never needs to be rebuilt.
+    Offsets and lengths are in bytes.
+ */
+class PieceTable {
+public:
+    /**
+        The constructor.
+        @param text the original text.
+     */
+    PieceTable(const std::string &text = std::string());
+
+    /**
+        Returns the length of the text.
+     */
+    size_t size() const {
+        return _getLength(m_root);
+    }
+
+    /**
+        Returns true if the text is empty.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+        Returns the number of pieces, for measuring the fragmentation of the text.
+     */
+    size_t getPieceCount() const {
+        return m_pieceCount;
+    }
+
+    /**
+        Returns the text.
+     */
+    std::string getText() const {
+        return getText(0, size());
+    }
+
+    /**
+        Returns part of the text.
+        @param offset offset of the part.
+        @param length length of the part; it is limited to the end of the text.
+     */
+    std::string getText(size_t offset, size_t length) const;
+
+    /**
+        Returns the byte at the given offset, which must be less than the length of the text.
+     */
+    char getChar(size_t offset) const;
+
+    /**
+        Replaces the text, and clears the buffer of added text.
+     */
+    void setText(const std::string &text);
+
+    /**
+        Inserts text.
+        @param offset offset to insert the text at; it is limited to the end of the text.
+        @param text text to insert.
+     */
+    void insert(size_t offset, const std::string &text);
+
+    /**
+        Erases text.
+        @param offset offset of the text to erase.
+        @param length length of the text to erase; it is limited to the end of the text.
+     */
+    void erase(size_t offset, size_t length);
+
+    /**
+        Returns the number of lines; it is the number of new lines plus one.
+     */
+    size_t getLineCount() const {
+        return _getNewlines(m_root) + 1;
+    }
+
+    /**
+        Returns the offset of the start of a line; for lines past the end, it returns the length of the text.
+     */
+    size_t getLineStart(size_t line) const;
+
+    /**
+        Returns the offset of the end of a line, i.e. of its new line, or the length of the text for the last line.
+     */
+    size_t getLineEnd(size_t line) const {
+        return line + 1 < getLineCount() ? getLineStart(line + 1) - 1 : size();
+    }
+
+    /**
+        Returns the line the given offset is in.
+     */
+    size_t getLineAt(size_t offset) const;
+
+private:
+    //null node index
+    static const uint32_t _nil = 0xffffffff;
+
+    //node of the tree; a piece of one of the buffers
+    struct _Node {
+        uint32_t left;
+        uint32_t right;
+        uint32_t priority;
+        bool added;
+        size_t start;
+        size_t length;
+        size_t newlines;
+        size_t subtreeLength;
+        size_t subtreeNewlines;
+    };
+
+    //buffers and the offsets of their new lines
+    std::string m_original;
+    std::string m_added;
+    std::vector<size_t> m_originalNewlines;
+    std::vector<size_t> m_addedNewlines;
+
+    //nodes; unused nodes are kept in a free list, through their left index
+    std::vector<_Node> m_nodes;
+    uint32_t m_free;
+
+    //root of the tree
+    uint32_t m_root;
+
+    //number of pieces
+    size_t m_pieceCount;
+
+    //state of the random number generator of the priorities
+    uint32_t m_random;
+
+    //returns the length of a subtree
+    size_t _getLength(uint32_t node) const {
+        return node != _nil ? m_nodes[node].subtreeLength : 0;
+    }
+
+    //returns the number of new lines of a subtree
+    size_t _getNewlines(uint32_t node) const {
+        return node != _nil ? m_nodes[node].subtreeNewlines : 0;
+    }
+
+    //returns the buffer of a node
+    const std::string &_getBuffer(const _Node &node) const {
+        return node.added ? m_added : m_original;
+    }
+
+    //returns the new lines of the buffer of a node
+    const std::vector<size_t> &_getBufferNewlines(bool added) const {
+        return added ? m_addedNewlines : m_originalNewlines;
+    }
+
+    //counts the new lines of part of a buffer
+    size_t _countNewlines(bool added, size_t start, size_t length) const;
+
+    //creates a node
+    uint32_t _create(bool added, size_t start, size_t length, uint32_t priority);
+
+    //frees the nodes of a subtree
+    void _destroy(uint32_t node);
+
+    //computes the length and new lines of a subtree from its children
+    void _update(uint32_t node);
+
+    //joins two trees; all pieces of the first are before those of the second
+    uint32_t _merge(uint32_t left, uint32_t right);
+
+    //splits a tree at the given offset, splitting the piece at that offset if needed
+    void _split(uint32_t node, size_t offset, uint32_t &left, uint32_t &right);
+
+    //extends the last piece of a tree by the given length of text, if it ends at the end of the added buffer
+    bool _extendLast(uint32_t node, size_t end, size_t length, size_t newlines);
+
+    //appends part of a subtree to a string
+    void _collect(uint32_t node, size_t offset, size_t length, std::string &result) const;
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_PIECETABLE_HPP
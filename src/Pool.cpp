@@ -0,0 +1,111 @@
+#include <vector>
+#include "Pool.hpp"
+#include "Mutex.hpp"
+
+
+namespace amgui {
+
+
+//block sizes are multiples of this
+static const size_t _granularity = 16;
+
+
+//number of size classes; blocks bigger than the biggest class are not pooled
+static const size_t _classCount = 64;
+
+
+//size of a slab
+static const size_t _slabSize = 64 * 1024;
+
+
+//a free block
+struct _FreeBlock {
+    _FreeBlock *next;
+};
+
+
+//the pool state
+struct _PoolState {
+    //free lists, one per size class
+    _FreeBlock *freeLists[_classCount];
+
+    //slabs; kept so that the memory is not reported as leaked
+    std::vector<char *> slabs;
+
+    //the last widget reference may be dropped by any thread, so access is serialized
+    Mutex mutex;
+
+    _PoolState() : freeLists() {
+    }
+};
+
+
+//returns the pool state;
+//it is never destroyed, since static widget pointers, such as the focus widget, may release their blocks after it would be
+static _PoolState &_getPoolState() {
+    static _PoolState &state = *new _PoolState;
+    return state;
+}
+
+
+//returns the size class for a size
+static size_t _getClass(size_t size) {
+    return (size + _granularity - 1) / _granularity - 1;
+}
+
+
+/**
+    Allocates a block of memory.
+    @param size number of bytes.
+    @return pointer to the block.
+ */
+void *Pool::allocate(size_t size) {
+    size_t sizeClass = _getClass(size);
+    if (size == 0 || sizeClass >= _classCount) {
+        return ::operator new(size);
+    }
+
+    _PoolState &state = _getPoolState();
+    MutexLock lock(state.mutex);
+
+    //if there are no free blocks, carve a new slab into blocks
+    if (!state.freeLists[sizeClass]) {
+        size_t blockSize = (sizeClass + 1) * _granularity;
+        char *slab = new char[_slabSize];
+        state.slabs.push_back(slab);
+        for(size_t offset = 0; offset + blockSize <= _slabSize; offset += blockSize) {
+            _FreeBlock *block = reinterpret_cast<_FreeBlock *>(slab + offset);
+            block->next = state.freeLists[sizeClass];
+            state.freeLists[sizeClass] = block;
+        }
+    }
+
+    _FreeBlock *block = state.freeLists[sizeClass];
+    state.freeLists[sizeClass] = block->next;
+    return block;
+}
+
+
+/**
+    Returns a block of memory to the pool.
+    @param p pointer to the block.
+    @param size the number of bytes the block was allocated with.
+ */
+void Pool::deallocate(void *p, size_t size) {
+    if (!p) return;
+
+    size_t sizeClass = _getClass(size);
+    if (size == 0 || sizeClass >= _classCount) {
+        ::operator delete(p);
+        return;
+    }
+
+    _PoolState &state = _getPoolState();
+    MutexLock lock(state.mutex);
+    _FreeBlock *block = static_cast<_FreeBlock *>(p);
+    block->next = state.freeLists[sizeClass];
+    state.freeLists[sizeClass] = block;
+}
+
+
+} //namespace amgui
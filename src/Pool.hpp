@@ -0,0 +1,107 @@
+#ifndef AMGUI_POOL_HPP
+#define AMGUI_POOL_HPP
+
+
+#include <cstddef>
+#include <new>
+
+
+namespace amgui {
+
+
+/**
+    A pool of memory blocks, grouped in size classes.
+    Blocks are carved out of big slabs and recycled through free lists,
+    so as that allocating many small objects of similar size is fast and the objects are close together in memory.
+    Memory given back to the pool is kept for reuse; it is not returned to the system.
+ */
+class Pool {
+public:
+    /**
+        Allocates a block of memory.
+        Blocks bigger than the biggest size class are allocated with operator new.
+        @param size number of bytes.
+        @return pointer to the block.
+        @exception std::bad_alloc thrown if there is no memory.
+     */
+    static void *allocate(size_t size);
+
+    /**
+        Returns a block of memory to the pool.
+        @param p pointer to the block.
+        @param size the number of bytes the block was allocated with.
+     */
+    static void deallocate(void *p, size_t size);
+};
+
+
+/**
+    Standard allocator which allocates single objects from the pool.
+    Arrays are allocated with operator new.
+ */
+template <class T> class PoolAllocator {
+public:
+    ///type of allocated values.
+    typedef T value_type;
+
+    /**
+        The default constructor.
+     */
+    PoolAllocator() {
+    }
+
+    /**
+        Constructor from an allocator of another type.
+     */
+    template <class U> PoolAllocator(const PoolAllocator<U> &) {
+    }
+
+    /**
+        Allocates memory for the given number of objects.
+     */
+    T *allocate(size_t n) {
+        return static_cast<T *>(n == 1 ? Pool::allocate(sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+
+    /**
+        Deallocates memory.
+     */
+    void deallocate(T *p, size_t n) {
+        if (n == 1) {
+            Pool::deallocate(p, sizeof(T));
+        }
+        else {
+            ::operator delete(p);
+        }
+    }
+
+    /**
+        Allows rebinding the allocator to another type.
+     */
+    template <class U> struct rebind {
+        ///the rebound allocator type.
+        typedef PoolAllocator<U> other;
+    };
+};
+
+
+/**
+    All pool allocators are equal.
+ */
+template <class T, class U> bool operator == (const PoolAllocator<T> &, const PoolAllocator<U> &) {
+    return true;
+}
+
+
+/**
+    All pool allocators are equal.
+ */
+template <class T, class U> bool operator != (const PoolAllocator<T> &, const PoolAllocator<U> &) {
+    return false;
+}
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_POOL_HPP
@@ -0,0 +1,98 @@
+#include "PostQueue.hpp"
+
+
+namespace amgui {
+
+
+//default number of functions invoked per event
+static const size_t _defaultBatchSize = 256;
+
+
+/**
+    The constructor.
+    Initializes the event source.
+ */
+PostQueue::PostQueue() :
+    m_head(nullptr),
+    m_tail(new _Node),
+    m_signaled(false),
+    m_batchSize(_defaultBatchSize)
+{
+    m_tail->next.store(nullptr, std::memory_order_relaxed);
+    m_head.store(m_tail, std::memory_order_relaxed);
+    al_init_user_event_source(&m_eventSource);
+}
+
+
+/**
+    The destructor.
+    Destroys the event source and the functions which were not invoked.
+ */
+PostQueue::~PostQueue() {
+    al_destroy_user_event_source(&m_eventSource);
+    while (m_tail) {
+        _Node *next = m_tail->next.load(std::memory_order_acquire);
+        delete m_tail;
+        m_tail = next;
+    }
+}
+
+
+/**
+    Posts a function; it can be called from any thread.
+ */
+void PostQueue::post(Function function) {
+    _Node *node = new _Node;
+    node->next.store(nullptr, std::memory_order_relaxed);
+    node->function = std::move(function);
+
+    //append the node; the consumer sees it once the previous node is linked to it
+    _Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+
+    //wake up the gui thread, unless it has been woken up already
+    if (!m_signaled.exchange(true, std::memory_order_acq_rel)) {
+        _signal();
+    }
+}
+
+
+/**
+    Invokes the posted functions, up to the batch size; it must be called from the gui thread only.
+    @return the number of invoked functions.
+ */
+size_t PostQueue::invoke() {
+    //functions posted from now on emit a new event
+    m_signaled.exchange(false, std::memory_order_acq_rel);
+
+    size_t count = 0;
+    for(; count < m_batchSize; ++count) {
+        _Node *next = m_tail->next.load(std::memory_order_acquire);
+        if (!next) break;
+
+        //the node becomes the new tail, after its function is taken
+        Function function = std::move(next->function);
+        delete m_tail;
+        m_tail = next;
+        function();
+    }
+
+    //if the batch is full, continue with another event
+    if (count == m_batchSize && m_tail->next.load(std::memory_order_acquire) && !m_signaled.exchange(true, std::memory_order_acq_rel)) {
+        _signal();
+    }
+
+    return count;
+}
+
+
+//emits an event
+void PostQueue::_signal() {
+    ALLEGRO_EVENT event;
+    event.user.type = eventType;
+    event.user.data1 = (intptr_t)this;
+    al_emit_user_event(&m_eventSource, &event, nullptr);
+}
+
+
+} //namespace amgui
@@ -0,0 +1,118 @@
+#ifndef AMGUI_POSTQUEUE_HPP
+#define AMGUI_POSTQUEUE_HPP
+
+
+#include <atomic>
+#include <functional>
+#include <allegro5/allegro.h>
+
+
+namespace amgui {
+
+
+/**
+    Queue of functions posted by any thread, to be invoked by the gui thread.
+    Posting is lock-free: producers never wait on each other or on the gui thread.
+    When functions are posted to an empty queue, a user event is emitted from the queue's event source,
+    so the gui thread wakes up and invokes them, by dispatching the event to the root widget.
+ */
+class PostQueue {
+public:
+    /**
+        Type of posted functions.
+     */
+    typedef std::function<void()> Function;
+
+    /**
+        Type of the events the queue emits.
+     */
+    static const ALLEGRO_EVENT_TYPE eventType = ALLEGRO_GET_EVENT_TYPE('A', 'M', 'P', 'Q');
+
+    /**
+        The constructor.
+        Initializes the event source.
+     */
+    PostQueue();
+
+    /**
+        The copy constructor is deleted.
+     */
+    PostQueue(const PostQueue &queue) = delete;
+
+    /**
+        The destructor.
+        Destroys the event source and the functions which were not invoked.
+     */
+    ~PostQueue();
+
+    /**
+        The copy assignment is deleted.
+     */
+    PostQueue &operator = (const PostQueue &queue) = delete;
+
+    /**
+        Returns the event source of the queue; it must be registered to the event queue of the gui thread.
+     */
+    ALLEGRO_EVENT_SOURCE *getEventSource() {
+        return &m_eventSource;
+    }
+
+    /**
+        Returns the maximum number of functions invoked for each event.
+     */
+    size_t getBatchSize() const {
+        return m_batchSize;
+    }
+
+    /**
+        Sets the maximum number of functions invoked for each event.
+        If more functions are queued, then another event is emitted,
+        so as that the rest are invoked after the events already in the event queue, such as timer events.
+        Must be called from the gui thread.
+     */
+    void setBatchSize(size_t size) {
+        m_batchSize = size > 0 ? size : 1;
+    }
+
+    /**
+        Posts a function; it can be called from any thread.
+     */
+    void post(Function function);
+
+    /**
+        Invokes the posted functions, up to the batch size; it must be called from the gui thread only.
+        @return the number of invoked functions.
+     */
+    size_t invoke();
+
+private:
+    //node of the queue
+    struct _Node {
+        std::atomic<_Node *> next;
+        Function function;
+    };
+
+    //the last node; producers exchange it with their node
+    std::atomic<_Node *> m_head;
+
+    //the node before the first queued node; only the gui thread uses it
+    _Node *m_tail;
+
+    //true if an event was emitted and the functions were not invoked yet
+    std::atomic<bool> m_signaled;
+
+    //maximum number of functions invoked per event
+    size_t m_batchSize;
+
+    //event source
+    ALLEGRO_EVENT_SOURCE m_eventSource;
+
+    //emits an event
+    void _signal();
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_POSTQUEUE_HPP
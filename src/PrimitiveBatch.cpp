@@ -0,0 +1,245 @@
+#include <cmath>
+#include "PrimitiveBatch.hpp"
+
+
+namespace amgui {
+
+
+//maximum number of vertices collected before the batch is flushed
+static const size_t _maxVertices = 65536;
+
+
+//returns the current blender
+static void _getBlender(int &op, int &src, int &dst, int &alphaOp, int &alphaSrc, int &alphaDst) {
+    al_get_separate_blender(&op, &src, &dst, &alphaOp, &alphaSrc, &alphaDst);
+}
+
+
+/**
+    The constructor.
+ */
+PrimitiveBatch::PrimitiveBatch() :
+    m_texture(nullptr),
+    m_blender{0, 0, 0, 0, 0, 0},
+    m_prev(nullptr),
+    m_begun(false),
+    m_drawCallCount(0),
+    m_primitiveCount(0)
+{
+}
+
+
+/**
+    The destructor.
+    Ends the batch, if it is the current one.
+ */
+PrimitiveBatch::~PrimitiveBatch() {
+    if (m_begun) {
+        end();
+    }
+}
+
+
+/**
+    Returns the current batch.
+    If no batch has begun, then a default batch is returned.
+ */
+PrimitiveBatch *PrimitiveBatch::getCurrent() {
+    static PrimitiveBatch defaultBatch;
+    return _current ? _current : &defaultBatch;
+}
+
+
+/**
+    Makes this batch the current one.
+ */
+void PrimitiveBatch::begin() {
+    if (m_begun) return;
+
+    //the primitives of the previous batch must be drawn before the primitives of this one
+    getCurrent()->flush();
+
+    m_prev = _current;
+    m_begun = true;
+    _current = this;
+}
+
+
+/**
+    Flushes this batch and restores the batch that was current before begin() was called.
+ */
+void PrimitiveBatch::end() {
+    if (!m_begun) return;
+    flush();
+    _current = m_prev;
+    m_prev = nullptr;
+    m_begun = false;
+}
+
+
+/**
+    Draws a filled rectangle.
+ */
+void PrimitiveBatch::drawFilledRectangle(float x1, float y1, float x2, float y2, const ALLEGRO_COLOR &color) {
+    _setState(nullptr);
+    _addRect(x1, y1, x2, y2, 0, 0, 0, 0, color);
+}
+
+
+/**
+    Draws the outline of a rectangle, centered on the rectangle's edges, like al_draw_rectangle does.
+ */
+void PrimitiveBatch::drawRectangle(float x1, float y1, float x2, float y2, const ALLEGRO_COLOR &color, float thickness) {
+    _setState(nullptr);
+    float h = (thickness > 0 ? thickness : 1) / 2;
+    _addRect(x1 - h, y1 - h, x2 + h, y1 + h, 0, 0, 0, 0, color);
+    _addRect(x1 - h, y2 - h, x2 + h, y2 + h, 0, 0, 0, 0, color);
+    _addRect(x1 - h, y1 + h, x1 + h, y2 - h, 0, 0, 0, 0, color);
+    _addRect(x2 - h, y1 + h, x2 + h, y2 - h, 0, 0, 0, 0, color);
+}
+
+
+/**
+    Draws a line.
+ */
+void PrimitiveBatch::drawLine(float x1, float y1, float x2, float y2, const ALLEGRO_COLOR &color, float thickness) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0) return;
+
+    //offset of the edges of the line from its center
+    float h = (thickness > 0 ? thickness : 1) / 2;
+    float nx = -dy / length * h;
+    float ny = dx / length * h;
+
+    _setState(nullptr);
+    _addQuad(x1 + nx, y1 + ny, x2 + nx, y2 + ny, x2 - nx, y2 - ny, x1 - nx, y1 - ny, color);
+}
+
+
+/**
+    Draws a region of a bitmap.
+ */
+void PrimitiveBatch::drawBitmapRegion(ALLEGRO_BITMAP *bitmap, float sx, float sy, float sw, float sh, float dx, float dy) {
+    //the parent of a registered sub-bitmap is the texture, so as that the sub-bitmaps of an atlas page share it
+    ALLEGRO_BITMAP *parent = al_get_parent_bitmap(bitmap);
+    if (parent) {
+        auto it = _getSubBitmaps().find(bitmap);
+        if (it != _getSubBitmaps().end()) {
+            sx += it->second.first;
+            sy += it->second.second;
+            bitmap = parent;
+        }
+    }
+
+    _setState(bitmap);
+    _addRect(dx, dy, dx + sw, dy + sh, sx, sy, sx + sw, sy + sh, al_map_rgba(255, 255, 255, 255));
+}
+
+
+/**
+    Registers a sub-bitmap, so as that it is drawn from its parent.
+    @param subBitmap sub-bitmap.
+    @param x x coordinate of the sub-bitmap in its parent.
+    @param y y coordinate of the sub-bitmap in its parent.
+ */
+void PrimitiveBatch::addSubBitmap(ALLEGRO_BITMAP *subBitmap, int x, int y) {
+    _getSubBitmaps()[subBitmap] = std::make_pair(x, y);
+}
+
+
+/**
+    Unregisters a sub-bitmap.
+ */
+void PrimitiveBatch::removeSubBitmap(ALLEGRO_BITMAP *subBitmap) {
+    _getSubBitmaps().erase(subBitmap);
+}
+
+
+/**
+    Draws the collected primitives.
+ */
+void PrimitiveBatch::flush() {
+    if (m_indices.empty()) return;
+
+    //draw with the blender the primitives were collected with
+    _Blender blender;
+    _getBlender(blender.op, blender.src, blender.dst, blender.alphaOp, blender.alphaSrc, blender.alphaDst);
+    bool restoreBlender = !(blender == m_blender);
+    if (restoreBlender) {
+        al_set_separate_blender(m_blender.op, m_blender.src, m_blender.dst, m_blender.alphaOp, m_blender.alphaSrc, m_blender.alphaDst);
+    }
+
+    al_draw_indexed_prim(m_vertices.data(), nullptr, m_texture, m_indices.data(), (int)m_indices.size(), ALLEGRO_PRIM_TRIANGLE_LIST);
+    ++m_drawCallCount;
+
+    if (restoreBlender) {
+        al_set_separate_blender(blender.op, blender.src, blender.dst, blender.alphaOp, blender.alphaSrc, blender.alphaDst);
+    }
+
+    m_vertices.clear();
+    m_indices.clear();
+}
+
+
+//the current batch
+PrimitiveBatch *PrimitiveBatch::_current = nullptr;
+
+
+//returns the position of each registered sub-bitmap in its parent;
+//it is never destroyed, since sub-bitmaps held by static objects may be unregistered after it would be
+std::unordered_map<ALLEGRO_BITMAP *, std::pair<int, int>> &PrimitiveBatch::_getSubBitmaps() {
+    static std::unordered_map<ALLEGRO_BITMAP *, std::pair<int, int>> &subBitmaps = *new std::unordered_map<ALLEGRO_BITMAP *, std::pair<int, int>>;
+    return subBitmaps;
+}
+
+
+//flushes the batch if the given state is different from the state of the collected primitives
+void PrimitiveBatch::_setState(ALLEGRO_BITMAP *texture) {
+    _Blender blender;
+    _getBlender(blender.op, blender.src, blender.dst, blender.alphaOp, blender.alphaSrc, blender.alphaDst);
+
+    if (texture != m_texture || !(blender == m_blender) || m_vertices.size() + 4 > _maxVertices) {
+        flush();
+        m_texture = texture;
+        m_blender = blender;
+    }
+
+    ++m_primitiveCount;
+}
+
+
+//adds a quad
+void PrimitiveBatch::_addQuad(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, const ALLEGRO_COLOR &color) {
+    int base = (int)m_vertices.size();
+    m_vertices.push_back(ALLEGRO_VERTEX{x1, y1, 0, 0, 0, color});
+    m_vertices.push_back(ALLEGRO_VERTEX{x2, y2, 0, 0, 0, color});
+    m_vertices.push_back(ALLEGRO_VERTEX{x3, y3, 0, 0, 0, color});
+    m_vertices.push_back(ALLEGRO_VERTEX{x4, y4, 0, 0, 0, color});
+    m_indices.push_back(base + 0);
+    m_indices.push_back(base + 1);
+    m_indices.push_back(base + 2);
+    m_indices.push_back(base + 0);
+    m_indices.push_back(base + 2);
+    m_indices.push_back(base + 3);
+}
+
+
+//adds an axis-aligned quad with texture coordinates
+void PrimitiveBatch::_addRect(float x1, float y1, float x2, float y2, float u1, float v1, float u2, float v2, const ALLEGRO_COLOR &color) {
+    int base = (int)m_vertices.size();
+    m_vertices.push_back(ALLEGRO_VERTEX{x1, y1, 0, u1, v1, color});
+    m_vertices.push_back(ALLEGRO_VERTEX{x2, y1, 0, u2, v1, color});
+    m_vertices.push_back(ALLEGRO_VERTEX{x2, y2, 0, u2, v2, color});
+    m_vertices.push_back(ALLEGRO_VERTEX{x1, y2, 0, u1, v2, color});
+    m_indices.push_back(base + 0);
+    m_indices.push_back(base + 1);
+    m_indices.push_back(base + 2);
+    m_indices.push_back(base + 0);
+    m_indices.push_back(base + 2);
+    m_indices.push_back(base + 3);
+}
+
+
+} //namespace amgui
@@ -0,0 +1,181 @@
+#ifndef AMGUI_PRIMITIVEBATCH_HPP
+#define AMGUI_PRIMITIVEBATCH_HPP
+
+
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_primitives.h>
+
+
+namespace amgui {
+
+
+/**
+    Collects primitives into a vertex buffer and draws them with as few calls to the primitives addon as possible.
+    Consecutive primitives with the same texture and blender are drawn with a single call,
+    so as that the drawing order is preserved.
+    The batch must be flushed before changing the target bitmap, the clipping rectangle or the transformation,
+    and before drawing anything without the batch.
+ */
+class PrimitiveBatch {
+public:
+    /**
+        The constructor.
+     */
+    PrimitiveBatch();
+
+    /**
+        The copy constructor is deleted.
+     */
+    PrimitiveBatch(const PrimitiveBatch &batch) = delete;
+
+    /**
+        The destructor.
+        Ends the batch, if it is the current one.
+     */
+    ~PrimitiveBatch();
+
+    /**
+        The copy assignment is deleted.
+     */
+    PrimitiveBatch &operator = (const PrimitiveBatch &batch) = delete;
+
+    /**
+        Returns the current batch.
+        If no batch has begun, then a default batch is returned.
+     */
+    static PrimitiveBatch *getCurrent();
+
+    /**
+        Makes this batch the current one.
+     */
+    void begin();
+
+    /**
+        Flushes this batch and restores the batch that was current before begin() was called.
+     */
+    void end();
+
+    /**
+        Draws a filled rectangle.
+     */
+    void drawFilledRectangle(float x1, float y1, float x2, float y2, const ALLEGRO_COLOR &color);
+
+    /**
+        Draws the outline of a rectangle, centered on the rectangle's edges, like al_draw_rectangle does.
+        A thickness less than or equal to 0 draws a 1 pixel wide outline.
+     */
+    void drawRectangle(float x1, float y1, float x2, float y2, const ALLEGRO_COLOR &color, float thickness);
+
+    /**
+        Draws a line.
+        A thickness less than or equal to 0 draws a 1 pixel wide line.
+     */
+    void drawLine(float x1, float y1, float x2, float y2, const ALLEGRO_COLOR &color, float thickness);
+
+    /**
+        Draws a bitmap.
+     */
+    void drawBitmap(ALLEGRO_BITMAP *bitmap, float x, float y) {
+        drawBitmapRegion(bitmap, 0, 0, al_get_bitmap_width(bitmap), al_get_bitmap_height(bitmap), x, y);
+    }
+
+    /**
+        Draws a region of a bitmap.
+        Regions of the same bitmap are batched together, so drawing from a shared bitmap
+        is preferable to drawing from many small bitmaps;
+        registered sub-bitmaps are drawn from their parent, so sub-bitmaps of the same parent are batched together too.
+     */
+    void drawBitmapRegion(ALLEGRO_BITMAP *bitmap, float sx, float sy, float sw, float sh, float dx, float dy);
+
+    /**
+        Registers a sub-bitmap, so as that it is drawn from its parent.
+        Allegro 5.0 does not report where a sub-bitmap is in its parent,
+        so the code that creates the sub-bitmap registers it; other sub-bitmaps are drawn as they are.
+        @param subBitmap sub-bitmap.
+        @param x x coordinate of the sub-bitmap in its parent.
+        @param y y coordinate of the sub-bitmap in its parent.
+     */
+    static void addSubBitmap(ALLEGRO_BITMAP *subBitmap, int x, int y);
+
+    /**
+        Unregisters a sub-bitmap; it must be called before the sub-bitmap is destroyed.
+     */
+    static void removeSubBitmap(ALLEGRO_BITMAP *subBitmap);
+
+    /**
+        Draws the collected primitives.
+     */
+    void flush();
+
+    /**
+        Returns the number of draw calls issued since the last call to resetStatistics().
+     */
+    size_t getDrawCallCount() const {
+        return m_drawCallCount;
+    }
+
+    /**
+        Returns the number of primitives collected since the last call to resetStatistics().
+     */
+    size_t getPrimitiveCount() const {
+        return m_primitiveCount;
+    }
+
+    /**
+        Resets the statistics.
+     */
+    void resetStatistics() {
+        m_drawCallCount = 0;
+        m_primitiveCount = 0;
+    }
+
+private:
+    //blender
+    struct _Blender {
+        int op, src, dst, alphaOp, alphaSrc, alphaDst;
+
+        bool operator == (const _Blender &b) const {
+            return op == b.op && src == b.src && dst == b.dst && alphaOp == b.alphaOp && alphaSrc == b.alphaSrc && alphaDst == b.alphaDst;
+        }
+    };
+
+    //vertices and indices collected so far
+    std::vector<ALLEGRO_VERTEX> m_vertices;
+    std::vector<int> m_indices;
+
+    //state of the collected primitives
+    ALLEGRO_BITMAP *m_texture;
+    _Blender m_blender;
+
+    //the batch that was current before this
+    PrimitiveBatch *m_prev;
+    bool m_begun;
+
+    //statistics
+    size_t m_drawCallCount;
+    size_t m_primitiveCount;
+
+    //the current batch
+    static PrimitiveBatch *_current;
+
+    //returns the position of each registered sub-bitmap in its parent
+    static std::unordered_map<ALLEGRO_BITMAP *, std::pair<int, int>> &_getSubBitmaps();
+
+    //flushes the batch if the given state is different from the state of the collected primitives
+    void _setState(ALLEGRO_BITMAP *texture);
+
+    //adds a quad
+    void _addQuad(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, const ALLEGRO_COLOR &color);
+
+    //adds an axis-aligned quad with texture coordinates
+    void _addRect(float x1, float y1, float x2, float y2, float u1, float v1, float u2, float v2, const ALLEGRO_COLOR &color);
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_PRIMITIVEBATCH_HPP
@@ -2,6 +2,9 @@
 #define AMGUI_RECT_HPP
 
 
+#include <algorithm>
+
+
 namespace amgui {
 
 
@@ -154,6 +157,55 @@ public:
         m_top = y;
     }
 
+    /**
+        Returns true if the rectangle has no area, i.e. if right is less than left or bottom is less than top.
+     */
+    bool isEmpty() const {
+        return m_right < m_left || m_bottom < m_top;
+    }
+
+    /**
+        Moves the rectangle by the given offset.
+     */
+    void translate(float dx, float dy) {
+        m_left   += dx;
+        m_top    += dy;
+        m_right  += dx;
+        m_bottom += dy;
+    }
+
+    /**
+        Returns the common area of this and the given rectangle.
+        The result is empty if the rectangles do not intersect.
+     */
+    Rect getIntersection(const Rect &r) const {
+        return Rect(std::max(m_left, r.m_left), std::max(m_top, r.m_top), std::min(m_right, r.m_right), std::min(m_bottom, r.m_bottom));
+    }
+
+    /**
+        Returns the smallest rectangle that contains both this and the given rectangle.
+        Empty rectangles are ignored.
+     */
+    Rect getUnion(const Rect &r) const {
+        if (isEmpty()) return r;
+        if (r.isEmpty()) return *this;
+        return Rect(std::min(m_left, r.m_left), std::min(m_top, r.m_top), std::max(m_right, r.m_right), std::max(m_bottom, r.m_bottom));
+    }
+
+    /**
+        Returns true if the rectangles have the same coordinates.
+     */
+    bool operator == (const Rect &r) const {
+        return m_left == r.m_left && m_top == r.m_top && m_right == r.m_right && m_bottom == r.m_bottom;
+    }
+
+    /**
+        Returns true if the rectangles have different coordinates.
+     */
+    bool operator != (const Rect &r) const {
+        return !operator == (r);
+    }
+
     /**
         Test intersection with point.
      */
@@ -165,7 +217,7 @@ public:
         Test intersection with rectangle.
      */
     bool intersects(const Rect &r) const {
-        return r.m_left <= m_right && r.m_right >= m_left && r.m_top <= m_bottom && r.m_bottom >= r.m_top;
+        return r.m_left <= m_right && r.m_right >= m_left && r.m_top <= m_bottom && r.m_bottom >= m_top;
     }
 
 private:
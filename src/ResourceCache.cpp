@@ -1,10 +1,18 @@
 #include <sstream>
+#include <climits>
+#include <algorithm>
 #include "ResourceCache.hpp"
+#include "PrimitiveBatch.hpp"
+#include "TextMetrics.hpp"
 
 
 namespace amgui {
 
 
+//space left to the right of and below each bitmap in an atlas page, so as that filtering does not mix neighbouring bitmaps
+static const int _atlasPadding = 1;
+
+
 //create the font id
 static std::string _makeFontId(const std::string &filename, int size, int flags) {
     std::stringstream stream;
@@ -13,6 +21,48 @@ static std::string _makeFontId(const std::string &filename, int size, int flags)
 }
 
 
+//draws the given characters into a small bitmap, so as that the font renders their glyphs into its glyph cache
+static void _prewarmFont(ALLEGRO_FONT *font, const std::string &characters) {
+    ALLEGRO_BITMAP *bitmap = al_create_bitmap(1, 1);
+    if (!bitmap) return;
+
+    //the target changes, so the primitives collected so far must be drawn first
+    PrimitiveBatch::getCurrent()->flush();
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP);
+    al_set_target_bitmap(bitmap);
+    al_hold_bitmap_drawing(true);
+    al_draw_text(font, al_map_rgb(255, 255, 255), 0, 0, 0, characters.c_str());
+    al_hold_bitmap_drawing(false);
+    al_restore_state(&state);
+    al_destroy_bitmap(bitmap);
+}
+
+
+//sets the target bitmap to a region of an atlas page, for copying bitmaps as they are;
+//the region is cleared, since space reused from a removed bitmap still holds its pixels, which would bleed into the padding
+static void _beginAtlasCopy(ALLEGRO_BITMAP *page, int x, int y, int width, int height, ALLEGRO_STATE &state) {
+    //the primitives collected so far may use the page, and the target changes
+    PrimitiveBatch::getCurrent()->flush();
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_TRANSFORM | ALLEGRO_STATE_BLENDER);
+    al_set_target_bitmap(page);
+    ALLEGRO_TRANSFORM transform;
+    al_identity_transform(&transform);
+    al_use_transform(&transform);
+    al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+    al_set_clipping_rectangle(x, y, width, height);
+    al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+}
+
+
+//destructor
+ResourceCache::~ResourceCache() {
+    for(const std::unique_ptr<_AtlasPage> &page : m_atlasPages) {
+        al_destroy_bitmap(page->bitmap);
+    }
+}
+
+
 //load a bitmap
 std::shared_ptr<ALLEGRO_BITMAP> ResourceCache::loadBitmap(const std::string &filename) {
     //find a bitmap in the cache
@@ -31,6 +81,19 @@ std::shared_ptr<ALLEGRO_BITMAP> ResourceCache::loadBitmap(const std::string &fil
         return nullptr;
     }
 
+    //in atlas mode, the bitmap is replaced by a sub-bitmap of a page
+    _AtlasPage *page = nullptr;
+    ALLEGRO_BITMAP *subBitmap = m_atlasEnabled ? _addToAtlas(bitmap, page) : nullptr;
+    if (subBitmap) {
+        al_destroy_bitmap(bitmap);
+        std::shared_ptr<ALLEGRO_BITMAP> result{subBitmap, [=](ALLEGRO_BITMAP *bmp) {
+            m_bitmaps.erase(m_bitmaps.find(filename));
+            _removeFromAtlas(page, bmp);
+        }};
+        m_bitmaps[filename] = result;
+        return result;
+    }
+
     //create and returned a shared pointer with a destructor that removes it from the cache
     std::shared_ptr<ALLEGRO_BITMAP> result{bitmap, [=](ALLEGRO_BITMAP *bmp) {
         m_bitmaps.erase(m_bitmaps.find(filename));
@@ -46,7 +109,7 @@ std::shared_ptr<ALLEGRO_BITMAP> ResourceCache::loadBitmap(const std::string &fil
 
 
 //loads a font
-std::shared_ptr<ALLEGRO_FONT> ResourceCache::loadFont(const std::string &filename, int size, int flags/* = 0*/) {
+std::shared_ptr<ALLEGRO_FONT> ResourceCache::loadFont(const std::string &filename, int size, int flags/* = 0*/, const std::string &prewarm/* = std::string()*/) {
     //find a font in the cache
     auto id = _makeFontId(filename, size, flags);
     auto cached = m_fonts.find(id);
@@ -64,9 +127,19 @@ std::shared_ptr<ALLEGRO_FONT> ResourceCache::loadFont(const std::string &filenam
         return nullptr;
     }
 
+    //render the glyphs of the given characters
+    if (!prewarm.empty()) {
+        double start = al_get_time();
+        _prewarmFont(font, prewarm);
+        m_prewarmTime += al_get_time() - start;
+        ALLEGRO_USTR_INFO info;
+        m_prewarmCount += al_ustr_length(al_ref_cstr(&info, prewarm.c_str()));
+    }
+
     //create and returned a shared pointer with a destructor that removes it from the cache
     std::shared_ptr<ALLEGRO_FONT> result{font, [=](ALLEGRO_FONT *fnt) {
         m_fonts.erase(m_fonts.find(id));
+        TextMetrics::releaseFont(fnt);
         al_destroy_font(fnt);
     }};
 
@@ -78,5 +151,196 @@ std::shared_ptr<ALLEGRO_FONT> ResourceCache::loadFont(const std::string &filenam
 }
 
 
+//set the atlas page size
+void ResourceCache::setAtlasPageSize(int size) {
+    m_atlasPageSize = std::max(size, 1);
+}
+
+
+//set the atlas max bitmap size
+void ResourceCache::setAtlasMaxBitmapSize(int size) {
+    m_atlasMaxBitmapSize = std::max(size, 0);
+}
+
+
+//get the atlas usage
+std::vector<ResourceCache::AtlasPageUsage> ResourceCache::getAtlasUsage() const {
+    std::vector<AtlasPageUsage> result;
+    for(const std::unique_ptr<_AtlasPage> &page : m_atlasPages) {
+        size_t usedPixels = 0;
+        for(const _AtlasEntry &entry : page->entries) {
+            usedPixels += (size_t)entry.width * entry.height;
+        }
+        result.push_back(AtlasPageUsage{page->width, page->height, page->entries.size(), usedPixels});
+    }
+    return result;
+}
+
+
+//copies a bitmap into an atlas page; returns null if it is not put in the atlas
+ALLEGRO_BITMAP *ResourceCache::_addToAtlas(ALLEGRO_BITMAP *bitmap, _AtlasPage *&page) {
+    const int width = al_get_bitmap_width(bitmap), height = al_get_bitmap_height(bitmap);
+    if (width > m_atlasMaxBitmapSize || height > m_atlasMaxBitmapSize) return nullptr;
+
+    //find space in a page; the space left by removed bitmaps is used first
+    int x, y;
+    page = nullptr;
+    for(auto it = m_atlasPages.begin(); !page && it != m_atlasPages.end(); ++it) {
+        if (_placeInFreeRegions((*it)->freeRegions, width + _atlasPadding, height + _atlasPadding, x, y)) {
+            page = it->get();
+        }
+    }
+    for(auto it = m_atlasPages.begin(); !page && it != m_atlasPages.end(); ++it) {
+        if (_placeOnSkyline((*it)->skyline, (*it)->width, (*it)->height, width + _atlasPadding, height + _atlasPadding, x, y)) {
+            page = it->get();
+        }
+    }
+
+    //add a page
+    if (!page) {
+        if (width + _atlasPadding > m_atlasPageSize || height + _atlasPadding > m_atlasPageSize) return nullptr;
+        ALLEGRO_BITMAP *pageBitmap = al_create_bitmap(m_atlasPageSize, m_atlasPageSize);
+        if (!pageBitmap) return nullptr;
+        ALLEGRO_STATE state;
+        _beginAtlasCopy(pageBitmap, 0, 0, m_atlasPageSize, m_atlasPageSize, state);
+        al_restore_state(&state);
+        m_atlasPages.push_back(std::unique_ptr<_AtlasPage>(new _AtlasPage{pageBitmap, m_atlasPageSize, m_atlasPageSize, {_SkylineSegment{0, 0, m_atlasPageSize}}, {}, {}}));
+        page = m_atlasPages.back().get();
+        _placeOnSkyline(page->skyline, page->width, page->height, width + _atlasPadding, height + _atlasPadding, x, y);
+    }
+
+    //copy the bitmap, clearing its padding too
+    ALLEGRO_STATE state;
+    _beginAtlasCopy(page->bitmap, x, y, width + _atlasPadding, height + _atlasPadding, state);
+    al_draw_bitmap(bitmap, (float)x, (float)y, 0);
+    al_restore_state(&state);
+
+    //the batch draws the sub-bitmap from the page
+    ALLEGRO_BITMAP *subBitmap = al_create_sub_bitmap(page->bitmap, x, y, width, height);
+    if (!subBitmap) {
+        _addFreeRegion(page->freeRegions, _AtlasRegion{x, y, width + _atlasPadding, height + _atlasPadding});
+        return nullptr;
+    }
+    PrimitiveBatch::addSubBitmap(subBitmap, x, y);
+    page->entries.push_back(_AtlasEntry{subBitmap, x, y, width, height});
+    return subBitmap;
+}
+
+
+//removes a bitmap from an atlas page; the page is destroyed when it becomes empty
+void ResourceCache::_removeFromAtlas(_AtlasPage *page, ALLEGRO_BITMAP *bitmap) {
+    auto it = std::find_if(page->entries.begin(), page->entries.end(), [&](const _AtlasEntry &entry) { return entry.bitmap == bitmap; });
+    _addFreeRegion(page->freeRegions, _AtlasRegion{it->x, it->y, it->width + _atlasPadding, it->height + _atlasPadding});
+    page->entries.erase(it);
+    PrimitiveBatch::removeSubBitmap(bitmap);
+    al_destroy_bitmap(bitmap);
+    if (!page->entries.empty()) return;
+
+    //the primitives collected so far may use the page
+    PrimitiveBatch::getCurrent()->flush();
+    al_destroy_bitmap(page->bitmap);
+    m_atlasPages.erase(std::find_if(m_atlasPages.begin(), m_atlasPages.end(), [&](const std::unique_ptr<_AtlasPage> &p) { return p.get() == page; }));
+}
+
+
+//places a rectangle in the smallest free region it fits in, keeping the rest of the region free; returns false if it fits in none
+bool ResourceCache::_placeInFreeRegions(std::vector<_AtlasRegion> &regions, int width, int height, int &x, int &y) {
+    size_t best = regions.size();
+    for(size_t i = 0; i < regions.size(); ++i) {
+        const _AtlasRegion &region = regions[i];
+        if (width <= region.width && height <= region.height && (best == regions.size() || (size_t)region.width * region.height < (size_t)regions[best].width * regions[best].height)) {
+            best = i;
+        }
+    }
+    if (best == regions.size()) return false;
+    const _AtlasRegion region = regions[best];
+    regions.erase(regions.begin() + best);
+    x = region.x;
+    y = region.y;
+
+    //the rest of the region is split along the shorter side left, which keeps the larger part as large as possible
+    const int right = region.width - width, bottom = region.height - height;
+    const bool splitBelow = right < bottom;
+    if (right > 0) {
+        regions.push_back(_AtlasRegion{x + width, y, right, splitBelow ? height : region.height});
+    }
+    if (bottom > 0) {
+        regions.push_back(_AtlasRegion{x, y + height, splitBelow ? region.width : width, bottom});
+    }
+    return true;
+}
+
+
+//adds a free region, joining it with the free regions it shares a whole edge with
+void ResourceCache::_addFreeRegion(std::vector<_AtlasRegion> &regions, _AtlasRegion region) {
+    for(size_t i = 0; i < regions.size(); ) {
+        const _AtlasRegion &other = regions[i];
+        const bool beside = other.y == region.y && other.height == region.height && (other.x + other.width == region.x || region.x + region.width == other.x);
+        const bool above = other.x == region.x && other.width == region.width && (other.y + other.height == region.y || region.y + region.height == other.y);
+        if (!beside && !above) {
+            ++i;
+            continue;
+        }
+
+        //the joined region may be joined with regions checked already
+        const int left = std::min(region.x, other.x), top = std::min(region.y, other.y);
+        region = _AtlasRegion{left, top, std::max(region.x + region.width, other.x + other.width) - left, std::max(region.y + region.height, other.y + other.height) - top};
+        regions.erase(regions.begin() + i);
+        i = 0;
+    }
+    regions.push_back(region);
+}
+
+
+//places a rectangle at the lowest, then leftmost, position on a skyline, and raises the skyline; returns false if it does not fit
+bool ResourceCache::_placeOnSkyline(std::vector<_SkylineSegment> &skyline, int pageWidth, int pageHeight, int width, int height, int &x, int &y) {
+    //find the position; the rectangle rests on the highest segment under it
+    size_t best = skyline.size();
+    int bestY = INT_MAX;
+    for(size_t i = 0; i < skyline.size() && skyline[i].x + width <= pageWidth; ++i) {
+        int top = 0;
+        for(size_t j = i; j < skyline.size() && skyline[j].x < skyline[i].x + width; ++j) {
+            top = std::max(top, skyline[j].y);
+        }
+        if (top + height <= pageHeight && top < bestY) {
+            best = i;
+            bestY = top;
+        }
+    }
+    if (best == skyline.size()) return false;
+    x = skyline[best].x;
+    y = bestY;
+
+    //the segments under the rectangle are replaced by its top edge
+    const int right = x + width;
+    size_t i = best;
+    while (i < skyline.size() && skyline[i].x < right) {
+        int segmentRight = skyline[i].x + skyline[i].width;
+        if (segmentRight <= right) {
+            skyline.erase(skyline.begin() + i);
+        }
+        else {
+            skyline[i].width = segmentRight - right;
+            skyline[i].x = right;
+            break;
+        }
+    }
+    skyline.insert(skyline.begin() + best, _SkylineSegment{x, y + height, width});
+
+    //neighbouring segments of the same height are joined
+    for(size_t j = best > 0 ? best - 1 : 0; j + 1 < skyline.size() && j <= best + 1; ) {
+        if (skyline[j].y == skyline[j + 1].y) {
+            skyline[j].width += skyline[j + 1].width;
+            skyline.erase(skyline.begin() + j + 1);
+        }
+        else {
+            ++j;
+        }
+    }
+
+    return true;
+}
+
+
 } //namespace amgui
 
@@ -5,6 +5,7 @@
 #include <memory>
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_font.h>
 
@@ -29,37 +30,201 @@ namespace amgui {
 
 /**
     A cache of resources loaded from disk.
+    In atlas mode, small bitmaps are packed into shared page bitmaps, and returned as sub-bitmaps of them,
+    so as that drawing different bitmaps of the same page does not switch textures, and can be batched.
+    A bitmap is never moved in its page, since the sub-bitmap handed out refers to its place;
+    the space of a removed bitmap is reused for the bitmaps that fit in it, and a page is destroyed when it becomes empty.
  */
 class ResourceCache {
 public:
+    /**
+        Usage of an atlas page.
+     */
+    struct AtlasPageUsage {
+        ///width of the page.
+        int width;
+
+        ///height of the page.
+        int height;
+
+        ///number of bitmaps in the page.
+        size_t bitmapCount;
+
+        ///number of pixels of the bitmaps in the page.
+        size_t usedPixels;
+    };
+
+    /**
+        The constructor.
+     */
+    ResourceCache() {
+    }
+
+    /**
+        The copy constructor is deleted.
+     */
+    ResourceCache(const ResourceCache &cache) = delete;
+
+    /**
+        The destructor.
+        Destroys the atlas pages; the bitmaps loaded by the cache must be released before it.
+     */
+    ~ResourceCache();
+
+    /**
+        The copy assignment is deleted.
+     */
+    ResourceCache &operator = (const ResourceCache &cache) = delete;
+
     /**
         Loads a bitmap.
         If the bitmap is in the cache, it is returned instead.
-        Otherwise, the bitmap is immediately loaded.
-        The bitmap is removed from the cache when all shared pointers to it go out of scope.
+        Otherwise, the bitmap is immediately loaded;
+        in atlas mode, if it is small enough, it is copied into an atlas page, and a sub-bitmap of the page is returned.
+        The bitmap is removed from the cache when all shared pointers to it go out of scope;
+        the space it took in its atlas page is reused for the bitmaps loaded afterwards.
         @param filename name of the bitmap to load.
         @return pointer to the loaded bitmap or null if it cannot be found.
      */
     std::shared_ptr<ALLEGRO_BITMAP> loadBitmap(const std::string &filename);
 
+    /**
+        Returns true if bitmaps are loaded into atlas pages.
+     */
+    bool isAtlasEnabled() const {
+        return m_atlasEnabled;
+    }
+
+    /**
+        Sets the atlas mode; it applies to the bitmaps loaded afterwards.
+     */
+    void setAtlasEnabled(bool enabled) {
+        m_atlasEnabled = enabled;
+    }
+
+    /**
+        Returns the width and height of atlas pages.
+     */
+    int getAtlasPageSize() const {
+        return m_atlasPageSize;
+    }
+
+    /**
+        Sets the width and height of the atlas pages created afterwards.
+     */
+    void setAtlasPageSize(int size);
+
+    /**
+        Returns the maximum width and height of bitmaps put in atlas pages; larger bitmaps are loaded as they are.
+     */
+    int getAtlasMaxBitmapSize() const {
+        return m_atlasMaxBitmapSize;
+    }
+
+    /**
+        Sets the maximum width and height of bitmaps put in atlas pages.
+     */
+    void setAtlasMaxBitmapSize(int size);
+
+    /**
+        Returns the usage of each atlas page.
+     */
+    std::vector<AtlasPageUsage> getAtlasUsage() const;
+
     /**
         Loads a font of the given size and flags.
         If the font with the specific size and flags is in the cache, it is returned instead.
         Otherwise, the font is immediately loaded.
-        The font is removed from the cache when all shared pointers to it go out of scope.
+        The font is removed from the cache when all shared pointers to it go out of scope,
+        along with its text measurements.
         @param filename name of the font to load.
         @param size size of the font.
         @param flags font flags.
+        @param prewarm UTF-8 characters to render into the glyph cache of the font when it is loaded,
+            so as that the first frames which draw them do not stall; a font found in the cache is not pre-warmed again.
         @return pointer to the loaded font or null if it cannot be found.
      */
-    std::shared_ptr<ALLEGRO_FONT> loadFont(const std::string &filename, int size, int flags = 0);
+    std::shared_ptr<ALLEGRO_FONT> loadFont(const std::string &filename, int size, int flags = 0, const std::string &prewarm = std::string());
+
+    /**
+        Returns the total number of seconds spent pre-warming fonts.
+     */
+    double getPrewarmTime() const {
+        return m_prewarmTime;
+    }
+
+    /**
+        Returns the total number of characters pre-warmed.
+     */
+    size_t getPrewarmCount() const {
+        return m_prewarmCount;
+    }
 
 private:
+    //region of a bitmap in an atlas page
+    struct _AtlasEntry {
+        ALLEGRO_BITMAP *bitmap;
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    //free space in an atlas page, left by removed bitmaps
+    struct _AtlasRegion {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    //part of the top edge of the space used in an atlas page
+    struct _SkylineSegment {
+        int x;
+        int y;
+        int width;
+    };
+
+    //atlas page
+    struct _AtlasPage {
+        ALLEGRO_BITMAP *bitmap;
+        int width;
+        int height;
+        std::vector<_SkylineSegment> skyline;
+        std::vector<_AtlasEntry> entries;
+        std::vector<_AtlasRegion> freeRegions;
+    };
+
     //bitmaps
     std::unordered_map<std::string, std::weak_ptr<ALLEGRO_BITMAP>> m_bitmaps;
 
     //fonts
     std::unordered_map<std::string, std::weak_ptr<ALLEGRO_FONT>> m_fonts;
+
+    //pre-warming statistics
+    double m_prewarmTime = 0;
+    size_t m_prewarmCount = 0;
+
+    //atlas
+    bool m_atlasEnabled = false;
+    int m_atlasPageSize = 1024;
+    int m_atlasMaxBitmapSize = 256;
+    std::vector<std::unique_ptr<_AtlasPage>> m_atlasPages;
+
+    //copies a bitmap into an atlas page; returns null if it is not put in the atlas
+    ALLEGRO_BITMAP *_addToAtlas(ALLEGRO_BITMAP *bitmap, _AtlasPage *&page);
+
+    //removes a bitmap from an atlas page; the page is destroyed when it becomes empty
+    void _removeFromAtlas(_AtlasPage *page, ALLEGRO_BITMAP *bitmap);
+
+    //places a rectangle in the smallest free region it fits in, keeping the rest of the region free; returns false if it fits in none
+    static bool _placeInFreeRegions(std::vector<_AtlasRegion> &regions, int width, int height, int &x, int &y);
+
+    //adds a free region, joining it with the free regions it shares a whole edge with
+    static void _addFreeRegion(std::vector<_AtlasRegion> &regions, _AtlasRegion region);
+
+    //places a rectangle at the lowest, then leftmost, position on a skyline, and raises the skyline; returns false if it does not fit
+    static bool _placeOnSkyline(std::vector<_SkylineSegment> &skyline, int pageWidth, int pageHeight, int width, int height, int &x, int &y);
 };
 
 
@@ -1,5 +1,6 @@
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 #include <sstream>
 #include "allegro5/allegro_color.h"
 #include "Skin.hpp"
@@ -19,6 +20,23 @@ static bool _parseFontValue(const char *value, std::string &filename, int &size,
 }
 
 
+//parse the prewarm value, i.e. pairs of first and last code points, into utf-8 characters
+static std::string _parsePrewarmValue(const char *value) {
+    std::string result;
+    Parser parser(value, _whitespace);
+    int first, last;
+    while (parser.parse(first, last)) {
+        for(int c = std::max(first, 1); c <= std::min(last, 0x10ffff); ++c) {
+            //surrogates are not characters
+            if (c >= 0xd800 && c <= 0xdfff) continue;
+            char buffer[4];
+            result.append(buffer, al_utf8_encode(buffer, c));
+        }
+    }
+    return result;
+}
+
+
 //why stricmp is not ANSI/POSIX? and why c++ doesn't have such a function?
 static int _stricmp(const char *str1, const char *str2) {
     //both strings are non-null; compare characters
@@ -52,6 +70,10 @@ static int _stricmp(const char *str1, const char *str2) {
 Skin::Skin(const char *filename) :
     m_config(al_load_config_file(filename), al_destroy_config)
 {
+    //the atlas mode applies to the bitmaps loaded afterwards, so it is set before any
+    m_resourceCache.setAtlasEnabled(getBool("skin", "atlas", m_resourceCache.isAtlasEnabled()));
+    m_resourceCache.setAtlasPageSize(getInt("skin", "atlas_page_size", m_resourceCache.getAtlasPageSize()));
+    m_resourceCache.setAtlasMaxBitmapSize(getInt("skin", "atlas_max_bitmap_size", m_resourceCache.getAtlasMaxBitmapSize()));
 }
 
 
@@ -83,6 +105,8 @@ std::shared_ptr<ALLEGRO_BITMAP> Skin::getBitmap(const char *section, const char
     If the filename is found, then the font is loaded (or retrieved from the resource cache),
     otherwise the default value is returned.
     The font filename can be followed by an optional size value (default is 12) and an optional flags value (the default is 0).
+    The characters to pre-warm when the font is loaded can be given at the key with the suffix '_prewarm',
+    as pairs of first and last code points.
  */
 std::shared_ptr<ALLEGRO_FONT> Skin::getFont(const char *section, const char *key, const std::shared_ptr<ALLEGRO_FONT> &defaultValue/* = nullptr*/) {
     //if empty, return the default value
@@ -99,8 +123,15 @@ std::shared_ptr<ALLEGRO_FONT> Skin::getFont(const char *section, const char *key
     int size = 12, flags = 0;
     if (!_parseFontValue(value, filename, size, flags)) return defaultValue;
 
+    //find the characters to pre-warm
+    std::string prewarm;
+    const char *prewarmValue = al_get_config_value(m_config.get(), section, (std::string(key) + "_prewarm").c_str());
+    if (prewarmValue) {
+        prewarm = _parsePrewarmValue(prewarmValue);
+    }
+
     //get the resource from the resource cache
-    auto result = m_resourceCache.loadFont(filename, size, flags);
+    auto result = m_resourceCache.loadFont(filename, size, flags, prewarm);
 
     //return either the result or the default value
     return result ? result : defaultValue;
@@ -16,6 +16,9 @@ class Skin {
 public:
     /**
         Loads a skin from a disk file.
+        The atlas mode of the resource cache is set from the section 'skin':
+        the key 'atlas' enables it, and the keys 'atlas_page_size' and 'atlas_max_bitmap_size' set its sizes.
+        For example: atlas=true.
         @param filename name of the Allegro config file to load for the skin.
      */
     Skin(const char *filename);
@@ -27,6 +30,20 @@ public:
         return !(bool)m_config;
     }
 
+    /**
+        Returns the resource cache, e.g. for its statistics.
+     */
+    const ResourceCache &getResourceCache() const {
+        return m_resourceCache;
+    }
+
+    /**
+        Returns the resource cache, e.g. for setting its atlas mode before bitmaps are loaded.
+     */
+    ResourceCache &getResourceCache() {
+        return m_resourceCache;
+    }
+
     /**
         Searches the internal config for a bitmap filename which corresponds to the given section and key.
         If the filename is found, then the bitmap is loaded (or retrieved from the resource cache),
@@ -40,6 +57,8 @@ public:
         otherwise the default value is returned.
         The font filename can be followed by an optional size value (default is 12) and an optional flags value (the default is 0).
         For example: myfont.ttf, 12, 0.
+        The characters to pre-warm when the font is loaded can be given at the key with the suffix '_prewarm',
+        as pairs of first and last code points. For example: font_prewarm=32-126, 0xa0-0xff.
      */
     std::shared_ptr<ALLEGRO_FONT> getFont(const char *section, const char *key, const std::shared_ptr<ALLEGRO_FONT> &defaultValue = nullptr);
 
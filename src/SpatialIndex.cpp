@@ -0,0 +1,119 @@
+#include <cmath>
+#include <algorithm>
+#include "SpatialIndex.hpp"
+
+
+namespace amgui {
+
+
+//maximum number of cells a widget may occupy before it is put in the large list
+static const int _maxCellsPerWidget = 64;
+
+
+//removes the given widget from a list, without preserving the order
+static void _removeWidget(SpatialIndex::Cell &cell, Widget *widget) {
+    auto it = std::find(cell.begin(), cell.end(), widget);
+    if (it != cell.end()) {
+        *it = cell.back();
+        cell.pop_back();
+    }
+}
+
+
+/**
+    The constructor.
+    @param cellSize width and height of each cell, in pixels.
+ */
+SpatialIndex::SpatialIndex(float cellSize/* = 64*/) :
+    m_cellSize(std::max(cellSize, 1.f))
+{
+}
+
+
+/**
+    Adds a widget to the index.
+    @param widget widget to add.
+    @param rect rectangle of the widget.
+ */
+void SpatialIndex::insert(Widget *widget, const Rect &rect) {
+    _Range range = _getRange(rect);
+
+    if (_isLarge(range)) {
+        m_large.push_back(widget);
+        return;
+    }
+
+    for(int row = range.top; row <= range.bottom; ++row) {
+        for(int col = range.left; col <= range.right; ++col) {
+            m_cells[_makeKey(col, row)].push_back(widget);
+        }
+    }
+}
+
+
+/**
+    Removes a widget from the index.
+    @param widget widget to remove.
+    @param rect rectangle the widget was inserted with.
+ */
+void SpatialIndex::remove(Widget *widget, const Rect &rect) {
+    _Range range = _getRange(rect);
+
+    if (_isLarge(range)) {
+        _removeWidget(m_large, widget);
+        return;
+    }
+
+    for(int row = range.top; row <= range.bottom; ++row) {
+        for(int col = range.left; col <= range.right; ++col) {
+            auto it = m_cells.find(_makeKey(col, row));
+            if (it == m_cells.end()) continue;
+            _removeWidget(it->second, widget);
+            if (it->second.empty()) {
+                m_cells.erase(it);
+            }
+        }
+    }
+}
+
+
+/**
+    Removes all widgets from the index.
+ */
+void SpatialIndex::clear() {
+    m_cells.clear();
+    m_large.clear();
+}
+
+
+/**
+    Returns the widgets registered in the cell that contains the given point,
+    or null if there are none.
+ */
+const SpatialIndex::Cell *SpatialIndex::find(float x, float y) const {
+    auto it = m_cells.find(_makeKey(_getCell(x), _getCell(y)));
+    return it != m_cells.end() ? &it->second : nullptr;
+}
+
+
+//returns the cells a rectangle occupies;
+//the rectangle covers the area [left, right + 1), as widgets do.
+SpatialIndex::_Range SpatialIndex::_getRange(const Rect &rect) const {
+    return _Range{_getCell(rect.getLeft()), _getCell(rect.getTop()), _getCell(rect.getRight() + 1), _getCell(rect.getBottom() + 1)};
+}
+
+
+//returns the cell coordinate for the given coordinate
+int SpatialIndex::_getCell(float v) const {
+    //clamp so as that the conversion to int does not overflow
+    return (int)std::floor(std::max(-1e9f, std::min(v / m_cellSize, 1e9f)));
+}
+
+
+//returns true if the range is too big to be put in cells
+bool SpatialIndex::_isLarge(const _Range &range) {
+    return (int64_t)(range.right - range.left + 1) * (range.bottom - range.top + 1) > _maxCellsPerWidget;
+}
+
+
+} //namespace amgui
@@ -0,0 +1,109 @@
+#ifndef AMGUI_SPATIALINDEX_HPP
+#define AMGUI_SPATIALINDEX_HPP
+
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "Rect.hpp"
+
+
+namespace amgui {
+
+
+class Widget;
+
+
+/**
+    A uniform grid of cells used for finding widgets from points.
+    Each widget is registered into all the cells its rectangle overlaps;
+    widgets that span too many cells are kept in a separate list which is always searched.
+    The index does not keep the order of widgets; the caller decides which of the found widgets wins.
+ */
+class SpatialIndex {
+public:
+    /**
+        List of widgets.
+     */
+    typedef std::vector<Widget *> Cell;
+
+    /**
+        The constructor.
+        @param cellSize width and height of each cell, in pixels.
+     */
+    SpatialIndex(float cellSize = 64);
+
+    /**
+        Returns the cell size.
+     */
+    float getCellSize() const {
+        return m_cellSize;
+    }
+
+    /**
+        Adds a widget to the index.
+        @param widget widget to add.
+        @param rect rectangle of the widget.
+     */
+    void insert(Widget *widget, const Rect &rect);
+
+    /**
+        Removes a widget from the index.
+        @param widget widget to remove.
+        @param rect rectangle the widget was inserted with.
+     */
+    void remove(Widget *widget, const Rect &rect);
+
+    /**
+        Removes all widgets from the index.
+     */
+    void clear();
+
+    /**
+        Returns the widgets registered in the cell that contains the given point,
+        or null if there are none.
+     */
+    const Cell *find(float x, float y) const;
+
+    /**
+        Returns the widgets that are too big to be registered into cells.
+     */
+    const Cell &getLarge() const {
+        return m_large;
+    }
+
+private:
+    //range of cells
+    struct _Range {
+        int left, top, right, bottom;
+    };
+
+    //cell size
+    float m_cellSize;
+
+    //cells
+    std::unordered_map<uint64_t, Cell> m_cells;
+
+    //widgets which occupy too many cells
+    Cell m_large;
+
+    //returns the cells a rectangle occupies
+    _Range _getRange(const Rect &rect) const;
+
+    //returns the cell coordinate for the given coordinate
+    int _getCell(float v) const;
+
+    //returns true if the range is too big to be put in cells
+    static bool _isLarge(const _Range &range);
+
+    //makes the key for a cell
+    static uint64_t _makeKey(int col, int row) {
+        return ((uint64_t)(uint32_t)col << 32) | (uint32_t)row;
+    }
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_SPATIALINDEX_HPP
@@ -0,0 +1,320 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "TextCache.hpp"
+#include "PrimitiveBatch.hpp"
+
+
+namespace amgui {
+
+
+//default budget
+static const size_t _defaultBudget = 32 * 1024 * 1024;
+
+
+//size of pages; larger runs get a page of their own
+static const int _pageSize = 1024;
+
+
+//space around the rendered text, so as that antialiased edges are not cut, nor mixed with neighbouring runs
+static const int _padding = 1;
+
+
+//the current cache
+TextCache *TextCache::_current = nullptr;
+
+
+//FNV-1a hash of the given bytes, continuing from the given hash
+static uint64_t _hash(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for(size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+
+//returns the hash of a run
+static uint64_t _hashRun(const ALLEGRO_FONT *font, const ALLEGRO_COLOR &color, int flags, const char *text) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = _hash(hash, &font, sizeof(font));
+    hash = _hash(hash, &color, sizeof(color));
+    hash = _hash(hash, &flags, sizeof(flags));
+    return _hash(hash, text, std::strlen(text));
+}
+
+
+/**
+    The constructor.
+    @param budget maximum number of bytes of the bitmaps.
+ */
+TextCache::TextCache(size_t budget/* = getDefaultBudget()*/) :
+    m_budget(budget),
+    m_memory(0)
+{
+}
+
+
+/**
+    The destructor.
+ */
+TextCache::~TextCache() {
+    clear();
+    if (_current == this) {
+        _current = nullptr;
+    }
+}
+
+
+/**
+    Returns the default budget.
+ */
+size_t TextCache::getDefaultBudget() {
+    return _defaultBudget;
+}
+
+
+/**
+    Draws text through the current cache, or with al_draw_text if there is no current cache.
+ */
+void TextCache::drawText(const std::shared_ptr<ALLEGRO_FONT> &font, const ALLEGRO_COLOR &color, float x, float y, int flags, const char *text) {
+    if (_current) {
+        _current->draw(font, color, x, y, flags, text);
+    }
+    else if (font) {
+        //the primitives collected so far are below the text
+        PrimitiveBatch::getCurrent()->flush();
+        al_draw_text(font.get(), color, x, y, flags, text);
+    }
+}
+
+
+/**
+    Draws text, rendering it into a bitmap if it is not in the cache.
+ */
+void TextCache::draw(const std::shared_ptr<ALLEGRO_FONT> &font, const ALLEGRO_COLOR &color, float x, float y, int flags, const char *text) {
+    if (!font || !text || !*text) return;
+
+    uint64_t hash = _hashRun(font.get(), color, flags, text);
+    _Entry *entry = _find(hash, font.get(), color, flags, text);
+    if (!entry) {
+        entry = _add(hash, font, color, flags, text);
+    }
+
+    //a run which does not fit is drawn directly, above the primitives collected so far
+    if (!entry) {
+        PrimitiveBatch::getCurrent()->flush();
+        al_draw_text(font.get(), color, x, y, flags, text);
+        return;
+    }
+
+    //a run without glyphs, such as spaces, has nothing to draw
+    if (!entry->page) return;
+
+    //the run is placed as al_draw_text would place it
+    float left = x + entry->alignment;
+    if (flags & ALLEGRO_ALIGN_INTEGER) {
+        left = std::floor(left);
+    }
+    PrimitiveBatch::getCurrent()->drawBitmapRegion(entry->page->bitmap, (float)entry->x, (float)entry->y, (float)entry->width, (float)entry->height, left + entry->offsetX, y + entry->offsetY);
+}
+
+
+/**
+    Sets the maximum number of bytes of the bitmaps.
+ */
+void TextCache::setBudget(size_t budget) {
+    m_budget = budget;
+    _trim();
+}
+
+
+/**
+    Removes all runs and destroys their bitmaps.
+ */
+void TextCache::clear() {
+    //the batch may refer to the pages
+    if (!m_pages.empty()) {
+        PrimitiveBatch::getCurrent()->flush();
+    }
+    for(const std::unique_ptr<_Page> &page : m_pages) {
+        al_destroy_bitmap(page->bitmap);
+    }
+    m_pages.clear();
+    m_entries.clear();
+    m_index.clear();
+    m_memory = 0;
+}
+
+
+//finds a run; returns null if it is not in the cache
+TextCache::_Entry *TextCache::_find(uint64_t hash, const ALLEGRO_FONT *font, const ALLEGRO_COLOR &color, int flags, const char *text) {
+    auto range = m_index.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it) {
+        _Entry &entry = *it->second;
+        if (entry.fontPointer == font &&
+            entry.flags == flags &&
+            std::memcmp(&entry.color, &color, sizeof(color)) == 0 &&
+            entry.text == text)
+        {
+            //a released font may have been replaced by another one at the same address;
+            //a page left without runs is destroyed
+            if (entry.font.expired()) {
+                _Page *page = entry.page;
+                _remove(it->second);
+                if (page && page->runCount == 0) {
+                    _removePage(page);
+                }
+                return nullptr;
+            }
+
+            //the run becomes the most recently drawn
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+
+//renders a run and adds it to the cache; returns null if there is no space for it
+TextCache::_Entry *TextCache::_add(uint64_t hash, const std::shared_ptr<ALLEGRO_FONT> &font, const ALLEGRO_COLOR &color, int flags, const char *text) {
+    //the bitmap covers the glyphs, relative to the left-aligned position of the text
+    int bbx, bby, bbw, bbh;
+    al_get_text_dimensions(font.get(), text, &bbx, &bby, &bbw, &bbh);
+    float alignment = 0;
+    if (flags & ALLEGRO_ALIGN_RIGHT) {
+        alignment = -(float)al_get_text_width(font.get(), text);
+    }
+    else if (flags & ALLEGRO_ALIGN_CENTRE) {
+        alignment = -(float)al_get_text_width(font.get(), text) / 2;
+    }
+
+    //render the run into a page; the region is cleared first, since it may have been used by an evicted run
+    _Page *page = nullptr;
+    int x = 0, y = 0, width = bbw + 2 * _padding, height = bbh + 2 * _padding;
+    if (bbw > 0 && bbh > 0) {
+        page = _allocate(width, height, x, y);
+        if (!page) return nullptr;
+        ++page->runCount;
+    }
+    if (page) {
+        //the target changes, so the primitives collected so far must be drawn first
+        PrimitiveBatch::getCurrent()->flush();
+        ALLEGRO_STATE state;
+        al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_TRANSFORM);
+        al_set_target_bitmap(page->bitmap);
+        ALLEGRO_TRANSFORM transform;
+        al_identity_transform(&transform);
+        al_use_transform(&transform);
+        al_set_clipping_rectangle(x, y, width, height);
+        al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+        al_draw_text(font.get(), color, (float)(x + _padding - bbx), (float)(y + _padding - bby), ALLEGRO_ALIGN_LEFT, text);
+        al_restore_state(&state);
+    }
+
+    m_entries.push_front(_Entry{hash, font.get(), font, text, color, flags, page, x, y, width, height, alignment, (float)(bbx - _padding), (float)(bby - _padding)});
+    m_index.insert(std::make_pair(hash, m_entries.begin()));
+    return &m_entries.front();
+}
+
+
+//finds space for a run in the pages, adding or reusing a page if needed; returns null if there is no space
+TextCache::_Page *TextCache::_allocate(int width, int height, int &x, int &y) {
+    //a row of a similar height, with enough space left
+    for(const std::unique_ptr<_Page> &page : m_pages) {
+        for(_Shelf &shelf : page->shelves) {
+            if (height <= shelf.height && height >= shelf.height * 3 / 4 && shelf.x + width <= page->width) {
+                x = shelf.x;
+                y = shelf.y;
+                shelf.x += width;
+                return page.get();
+            }
+        }
+    }
+
+    //a new row, in a page with enough space below its rows
+    for(const std::unique_ptr<_Page> &page : m_pages) {
+        if (page->top + height <= page->height && width <= page->width) {
+            page->shelves.push_back(_Shelf{page->top, height, width});
+            x = 0;
+            y = page->top;
+            page->top += height;
+            return page.get();
+        }
+    }
+
+    //a new page; larger runs get a page of their own size;
+    //a page which does not fit in the budget, even with the cache emptied, is not created
+    int pageWidth = std::max(width, _pageSize), pageHeight = std::max(height, _pageSize);
+    size_t bytes = (size_t)pageWidth * pageHeight * 4;
+    if (bytes > m_budget) return nullptr;
+    _trim(bytes);
+    if (m_memory + bytes > m_budget) return nullptr;
+    ALLEGRO_BITMAP *bitmap = al_create_bitmap(pageWidth, pageHeight);
+    if (!bitmap) return nullptr;
+    m_pages.push_back(std::unique_ptr<_Page>(new _Page{bitmap, pageWidth, pageHeight, height, {_Shelf{0, height, width}}, 0}));
+    m_memory += bytes;
+    x = 0;
+    y = 0;
+    return m_pages.back().get();
+}
+
+
+//removes a run
+void TextCache::_remove(_List::iterator it) {
+    auto range = m_index.equal_range(it->hash);
+    for(auto indexIt = range.first; indexIt != range.second; ++indexIt) {
+        if (indexIt->second == it) {
+            m_index.erase(indexIt);
+            break;
+        }
+    }
+    if (it->page) {
+        --it->page->runCount;
+    }
+    m_entries.erase(it);
+}
+
+
+//removes the runs of a page and destroys it
+void TextCache::_removePage(_Page *page) {
+    if (!page) return;
+    for(auto it = m_entries.begin(); it != m_entries.end(); ) {
+        auto next = std::next(it);
+        if (it->page == page) {
+            _remove(it);
+        }
+        it = next;
+    }
+
+    //the batch may refer to the page
+    PrimitiveBatch::getCurrent()->flush();
+    al_destroy_bitmap(page->bitmap);
+    m_memory -= (size_t)page->width * page->height * 4;
+    m_pages.erase(std::find_if(m_pages.begin(), m_pages.end(), [&](const std::unique_ptr<_Page> &p) { return p.get() == page; }));
+}
+
+
+//destroys the pages without runs, then removes the pages of the least recently drawn runs
+//until the memory plus the given bytes is within the budget
+void TextCache::_trim(size_t bytes/* = 0*/) {
+    //the runs of a page may all have been removed because their fonts were released
+    for(size_t i = m_pages.size(); i-- > 0; ) {
+        if (m_pages[i]->runCount == 0) {
+            _removePage(m_pages[i].get());
+        }
+    }
+
+    while (m_memory + bytes > m_budget && !m_entries.empty()) {
+        if (m_entries.back().page) {
+            _removePage(m_entries.back().page);
+        }
+        else {
+            _remove(std::prev(m_entries.end()));
+        }
+    }
+}
+
+
+} //namespace amgui
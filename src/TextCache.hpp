@@ -0,0 +1,219 @@
+#ifndef AMGUI_TEXTCACHE_HPP
+#define AMGUI_TEXTCACHE_HPP
+
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+
+
+namespace amgui {
+
+
+/**
+    Cache of text runs rendered into bitmaps.
+    Drawing a run that is in the cache draws a single bitmap region through the current primitive batch,
+    instead of drawing each glyph again.
+    Runs are packed in rows into a few large page bitmaps, so as that the batch draws many runs with one call.
+    Runs are identified by font, text, color and flags; looking up a run does not allocate memory.
+    When a new page would exceed the budget, the page of the least recently drawn run is emptied and reused.
+    Runs which do not fit in the budget are drawn with al_draw_text, without being cached.
+    The cache keeps weak pointers to the fonts, so the runs of a font that was released are never drawn;
+    their space is reclaimed along with their page.
+ */
+class TextCache {
+public:
+    /**
+        The constructor.
+        @param budget maximum number of bytes of the bitmaps.
+     */
+    TextCache(size_t budget = getDefaultBudget());
+
+    /**
+        The copy constructor is deleted.
+     */
+    TextCache(const TextCache &cache) = delete;
+
+    /**
+        The destructor.
+        Destroys the bitmaps; if the cache is the current one, there is no current cache afterwards.
+     */
+    ~TextCache();
+
+    /**
+        The copy assignment is deleted.
+     */
+    TextCache &operator = (const TextCache &cache) = delete;
+
+    /**
+        Returns the default budget.
+     */
+    static size_t getDefaultBudget();
+
+    /**
+        Returns the current cache, or null if there is none.
+     */
+    static TextCache *getCurrent() {
+        return _current;
+    }
+
+    /**
+        Sets the current cache, used by drawText().
+        @param cache the new current cache; it may be null.
+     */
+    static void setCurrent(TextCache *cache) {
+        _current = cache;
+    }
+
+    /**
+        Draws text through the current cache, or with al_draw_text if there is no current cache.
+        Widgets can use it from their draw() method in place of al_draw_text.
+        @param font font.
+        @param color color.
+        @param x x coordinate.
+        @param y y coordinate.
+        @param flags flags of al_draw_text.
+        @param text text.
+     */
+    static void drawText(const std::shared_ptr<ALLEGRO_FONT> &font, const ALLEGRO_COLOR &color, float x, float y, int flags, const char *text);
+
+    /**
+        Draws text, rendering it into a bitmap if it is not in the cache.
+        The bitmap is drawn through the current primitive batch.
+        @param font font.
+        @param color color.
+        @param x x coordinate.
+        @param y y coordinate.
+        @param flags flags of al_draw_text.
+        @param text text.
+     */
+    void draw(const std::shared_ptr<ALLEGRO_FONT> &font, const ALLEGRO_COLOR &color, float x, float y, int flags, const char *text);
+
+    /**
+        Draws text, rendering it into a bitmap if it is not in the cache.
+     */
+    void draw(const std::shared_ptr<ALLEGRO_FONT> &font, const ALLEGRO_COLOR &color, float x, float y, int flags, const std::string &text) {
+        draw(font, color, x, y, flags, text.c_str());
+    }
+
+    /**
+        Returns the maximum number of bytes of the bitmaps.
+     */
+    size_t getBudget() const {
+        return m_budget;
+    }
+
+    /**
+        Sets the maximum number of bytes of the bitmaps; pages are removed as needed.
+     */
+    void setBudget(size_t budget);
+
+    /**
+        Returns the number of bytes of the bitmaps.
+     */
+    size_t getMemory() const {
+        return m_memory;
+    }
+
+    /**
+        Returns the number of page bitmaps.
+     */
+    size_t getPageCount() const {
+        return m_pages.size();
+    }
+
+    /**
+        Returns the number of runs in the cache.
+     */
+    size_t size() const {
+        return m_entries.size();
+    }
+
+    /**
+        Removes all runs and destroys their bitmaps.
+     */
+    void clear();
+
+private:
+    //row of runs in a page
+    struct _Shelf {
+        int y;
+        int height;
+        int x;
+    };
+
+    //page bitmap
+    struct _Page {
+        ALLEGRO_BITMAP *bitmap;
+        int width;
+        int height;
+        int top;
+        std::vector<_Shelf> shelves;
+        size_t runCount;
+    };
+
+    //a rendered run
+    struct _Entry {
+        uint64_t hash;
+        const ALLEGRO_FONT *fontPointer;
+        std::weak_ptr<ALLEGRO_FONT> font;
+        std::string text;
+        ALLEGRO_COLOR color;
+        int flags;
+        _Page *page;
+        int x;
+        int y;
+        int width;
+        int height;
+        float alignment;
+        float offsetX;
+        float offsetY;
+    };
+
+    //runs, most recently drawn first
+    typedef std::list<_Entry> _List;
+    _List m_entries;
+
+    //runs, by hash
+    std::unordered_multimap<uint64_t, _List::iterator> m_index;
+
+    //pages
+    std::vector<std::unique_ptr<_Page>> m_pages;
+
+    //memory
+    size_t m_budget;
+    size_t m_memory;
+
+    //the current cache
+    static TextCache *_current;
+
+    //finds a run; returns null if it is not in the cache
+    _Entry *_find(uint64_t hash, const ALLEGRO_FONT *font, const ALLEGRO_COLOR &color, int flags, const char *text);
+
+    //renders a run and adds it to the cache; returns null if there is no space for it
+    _Entry *_add(uint64_t hash, const std::shared_ptr<ALLEGRO_FONT> &font, const ALLEGRO_COLOR &color, int flags, const char *text);
+
+    //finds space for a run in the pages, adding or reusing a page if needed; returns null if there is no space
+    _Page *_allocate(int width, int height, int &x, int &y);
+
+    //removes a run
+    void _remove(_List::iterator it);
+
+    //removes the runs of a page and destroys it
+    void _removePage(_Page *page);
+
+    //destroys the pages without runs, then removes the pages of the least recently drawn runs
+    //until the memory plus the given bytes is within the budget
+    void _trim(size_t bytes = 0);
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_TEXTCACHE_HPP
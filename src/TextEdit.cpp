@@ -0,0 +1,373 @@
+#include <cmath>
+#include <algorithm>
+#include "TextEdit.hpp"
+#include "PrimitiveBatch.hpp"
+
+
+namespace amgui {
+
+
+//default pixels per wheel step
+static const float _defaultWheelStep = 48;
+
+
+//returns true if the given byte starts a utf-8 character
+static bool _isCharStart(char c) {
+    return (c & 0xc0) != 0x80;
+}
+
+
+/**
+    The constructor.
+ */
+TextEdit::TextEdit() :
+    m_color(al_map_rgb(0, 0, 0)),
+    m_cursor(0),
+    m_preferredX(-1),
+    m_scrollY(0),
+    m_scrollX(0),
+    m_wheelStep(_defaultWheelStep)
+{
+}
+
+
+/**
+    Sets the text; the cursor is moved to the start of it.
+ */
+void TextEdit::setText(const std::string &text) {
+    m_document.setText(text);
+    m_cursor = 0;
+    m_preferredX = -1;
+    m_scrollY = 0;
+    m_scrollX = 0;
+    invalidate();
+}
+
+
+/**
+    Sets the font.
+ */
+void TextEdit::setFont(const std::shared_ptr<ALLEGRO_FONT> &font) {
+    if (font == m_font) return;
+    m_font = font;
+    m_preferredX = -1;
+    _scrollToCursor();
+    invalidate();
+}
+
+
+/**
+    Sets the color of the text and of the cursor.
+ */
+void TextEdit::setColor(const ALLEGRO_COLOR &color) {
+    m_color = color;
+    invalidate();
+}
+
+
+/**
+    Sets the offset of the cursor, and scrolls to it.
+ */
+void TextEdit::setCursor(size_t offset) {
+    offset = std::min(offset, m_document.size());
+    while (offset > 0 && offset < m_document.size() && !_isCharStart(m_document.getChar(offset))) {
+        --offset;
+    }
+    m_preferredX = -1;
+    if (offset == m_cursor) return;
+    m_cursor = offset;
+    _scrollToCursor();
+    invalidate();
+}
+
+
+/**
+    Inserts text at the cursor, and moves the cursor after it.
+ */
+void TextEdit::insertText(const std::string &text) {
+    m_document.insert(m_cursor, text);
+    m_cursor += text.size();
+    m_preferredX = -1;
+    _scrollToCursor();
+    invalidate();
+}
+
+
+/**
+    Sets the vertical scroll position.
+ */
+void TextEdit::setScrollPosition(double position) {
+    position = std::max(std::min(position, m_document.getLineCount() * (double)_getLineHeight() - getHeight()), 0.0);
+    if (position == m_scrollY) return;
+    m_scrollY = position;
+    invalidate();
+}
+
+
+/**
+    Draws the visible lines and the cursor, then the children.
+ */
+void TextEdit::draw(float x, float y, bool enabled, bool highlighted, bool pushed, bool selected) {
+    const float lineHeight = _getLineHeight();
+    if (lineHeight > 0) {
+        const float left = x + getX(), top = y + getY();
+
+        //lines are clipped to the widget
+        int clipX, clipY, clipWidth, clipHeight;
+        al_get_clipping_rectangle(&clipX, &clipY, &clipWidth, &clipHeight);
+        Rect clip = Rect(clipX, clipY, clipX + clipWidth - 1, clipY + clipHeight - 1).getIntersection(Rect(left, top, left + getWidth() - 1, top + getHeight() - 1));
+        if (!clip.isEmpty()) {
+            PrimitiveBatch *batch = PrimitiveBatch::getCurrent();
+            batch->flush();
+            al_set_clipping_rectangle((int)std::floor(clip.getLeft()), (int)std::floor(clip.getTop()), (int)std::ceil(clip.getRight()) - (int)std::floor(clip.getLeft()) + 1, (int)std::ceil(clip.getBottom()) - (int)std::floor(clip.getTop()) + 1);
+
+            //only the lines within the clipping rectangle are read from the document and drawn
+            const size_t lineCount = m_document.getLineCount();
+            const size_t first = (size_t)std::max(std::floor((m_scrollY + clip.getTop() - top) / lineHeight), 0.0);
+            const size_t end = std::min((size_t)std::max(std::floor((m_scrollY + clip.getBottom() - top) / lineHeight) + 1, 0.0), lineCount);
+            size_t start = first < end ? m_document.getLineStart(first) : 0;
+            for(size_t line = first; line < end; ++line) {
+                size_t next = m_document.getLineStart(line + 1);
+                size_t length = next - start - (line + 1 < lineCount ? 1 : 0);
+                std::string text = m_document.getText(start, length);
+                al_draw_text(m_font.get(), m_color, left - m_scrollX, (float)(top + line * (double)lineHeight - m_scrollY), 0, text.c_str());
+                start = next;
+            }
+
+            //the cursor
+            if (hasFocus()) {
+                float cursorX = left + _getX(m_cursor) - m_scrollX;
+                float cursorY = (float)(top + m_document.getLineAt(m_cursor) * (double)lineHeight - m_scrollY);
+                batch->drawFilledRectangle(cursorX, cursorY, cursorX + 1, cursorY + lineHeight, m_color);
+                batch->flush();
+            }
+
+            al_set_clipping_rectangle(clipX, clipY, clipWidth, clipHeight);
+        }
+    }
+
+    Widget::draw(x, y, enabled, highlighted, pushed, selected);
+}
+
+
+/**
+    Sets the focus to the widget, and moves the cursor to the given point, unless a child processes the event.
+ */
+bool TextEdit::leftButtonDown(int x, int y) {
+    if (Widget::leftButtonDown(x, y)) return true;
+    setFocus();
+    const float lineHeight = _getLineHeight();
+    if (lineHeight > 0) {
+        double line = std::max(std::floor((m_scrollY + y) / lineHeight), 0.0);
+        setCursor(_getOffsetAt(std::min((size_t)line, m_document.getLineCount() - 1), x + m_scrollX));
+    }
+    return true;
+}
+
+
+/**
+    Scrolls the text, unless a child processes the event.
+ */
+bool TextEdit::mouseWheel(int z, int w) {
+    if (Widget::mouseWheel(z, w)) return true;
+    if (!getMouseWheelDeltaZ()) return false;
+    setScrollPosition(m_scrollY - getMouseWheelDeltaZ() * m_wheelStep);
+    return true;
+}
+
+
+/**
+    Edits the text, or moves the cursor.
+ */
+bool TextEdit::keyChar(int keycode, int unichar, int modifiers) {
+    const bool ctrl = (modifiers & ALLEGRO_KEYMOD_CTRL) != 0;
+    const size_t line = m_document.getLineAt(m_cursor);
+    const float lineHeight = _getLineHeight();
+    const size_t pageLines = lineHeight > 0 ? std::max((size_t)(getHeight() / lineHeight), (size_t)1) : 1;
+
+    switch (keycode) {
+        case ALLEGRO_KEY_LEFT:
+            setCursor(_getPrevChar(m_cursor));
+            return true;
+
+        case ALLEGRO_KEY_RIGHT:
+            setCursor(_getNextChar(m_cursor));
+            return true;
+
+        case ALLEGRO_KEY_UP:
+            _moveCursorToLine(line > 0 ? line - 1 : 0);
+            return true;
+
+        case ALLEGRO_KEY_DOWN:
+            _moveCursorToLine(line + 1);
+            return true;
+
+        case ALLEGRO_KEY_PGUP:
+            _moveCursorToLine(line > pageLines ? line - pageLines : 0);
+            return true;
+
+        case ALLEGRO_KEY_PGDN:
+            _moveCursorToLine(line + pageLines);
+            return true;
+
+        case ALLEGRO_KEY_HOME:
+            setCursor(ctrl ? 0 : m_document.getLineStart(line));
+            return true;
+
+        case ALLEGRO_KEY_END:
+            setCursor(ctrl ? m_document.size() : m_document.getLineEnd(line));
+            return true;
+
+        case ALLEGRO_KEY_BACKSPACE:
+            if (m_cursor > 0) {
+                size_t prev = _getPrevChar(m_cursor);
+                m_document.erase(prev, m_cursor - prev);
+                m_cursor = prev;
+                m_preferredX = -1;
+                _scrollToCursor();
+                invalidate();
+            }
+            return true;
+
+        case ALLEGRO_KEY_DELETE:
+            if (m_cursor < m_document.size()) {
+                m_document.erase(m_cursor, _getNextChar(m_cursor) - m_cursor);
+                m_preferredX = -1;
+                invalidate();
+            }
+            return true;
+
+        case ALLEGRO_KEY_ENTER:
+        case ALLEGRO_KEY_PAD_ENTER:
+            insertText("\n");
+            return true;
+    }
+
+    //printable characters
+    if (unichar >= 32 && unichar != 127 && !ctrl) {
+        char buffer[4];
+        insertText(std::string(buffer, al_utf8_encode(buffer, unichar)));
+        return true;
+    }
+
+    return Widget::keyChar(keycode, unichar, modifiers);
+}
+
+
+/**
+    Shows the cursor.
+ */
+bool TextEdit::gotFocus() {
+    invalidate();
+    return true;
+}
+
+
+/**
+    Hides the cursor.
+ */
+bool TextEdit::lostFocus() {
+    invalidate();
+    return true;
+}
+
+
+//returns the height of lines
+float TextEdit::_getLineHeight() const {
+    return m_font ? (float)al_get_font_line_height(m_font.get()) : 0;
+}
+
+
+//returns the offset of the previous character
+size_t TextEdit::_getPrevChar(size_t offset) const {
+    if (offset == 0) return 0;
+    for(--offset; offset > 0 && !_isCharStart(m_document.getChar(offset)); --offset);
+    return offset;
+}
+
+
+//returns the offset of the next character
+size_t TextEdit::_getNextChar(size_t offset) const {
+    if (offset >= m_document.size()) return m_document.size();
+    for(++offset; offset < m_document.size() && !_isCharStart(m_document.getChar(offset)); ++offset);
+    return offset;
+}
+
+
+//returns the x coordinate of an offset, relative to the start of its line
+float TextEdit::_getX(size_t offset) const {
+    if (!m_font) return 0;
+    size_t start = m_document.getLineStart(m_document.getLineAt(offset));
+    return (float)al_get_text_width(m_font.get(), m_document.getText(start, offset - start).c_str());
+}
+
+
+//returns the offset of the character boundary nearest to the given x coordinate in a line
+size_t TextEdit::_getOffsetAt(size_t line, float x) const {
+    const size_t start = m_document.getLineStart(line);
+    if (!m_font || x <= 0) return start;
+    const std::string text = m_document.getText(start, m_document.getLineEnd(line) - start);
+
+    //find the boundaries before and after the x coordinate
+    size_t low = 0, high = text.size();
+    if (al_get_text_width(m_font.get(), text.c_str()) <= x) return start + text.size();
+    while (true) {
+        size_t middle = low + (high - low) / 2;
+        while (middle > low && !_isCharStart(text[middle])) --middle;
+        if (middle == low) {
+            for(++middle; middle < high && !_isCharStart(text[middle]); ++middle);
+            if (middle == high) break;
+        }
+        if (al_get_text_width(m_font.get(), text.substr(0, middle).c_str()) <= x) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    //the nearest of the two
+    float lowX = (float)al_get_text_width(m_font.get(), text.substr(0, low).c_str());
+    float highX = (float)al_get_text_width(m_font.get(), text.substr(0, high).c_str());
+    return start + (x - lowX < highX - x ? low : high);
+}
+
+
+//moves the cursor to another line, keeping its x coordinate
+void TextEdit::_moveCursorToLine(size_t line) {
+    line = std::min(line, m_document.getLineCount() - 1);
+    if (m_preferredX < 0) {
+        m_preferredX = _getX(m_cursor);
+    }
+    size_t offset = _getOffsetAt(line, m_preferredX);
+    if (offset == m_cursor) return;
+    m_cursor = offset;
+    _scrollToCursor();
+    invalidate();
+}
+
+
+//scrolls the least needed for the cursor to be visible
+void TextEdit::_scrollToCursor() {
+    const float lineHeight = _getLineHeight();
+    if (lineHeight <= 0) return;
+
+    double top = m_document.getLineAt(m_cursor) * (double)lineHeight;
+    if (top < m_scrollY) {
+        m_scrollY = top;
+    }
+    else if (top + lineHeight > m_scrollY + getHeight()) {
+        m_scrollY = top + lineHeight - getHeight();
+    }
+
+    float x = _getX(m_cursor);
+    if (x < m_scrollX) {
+        m_scrollX = x;
+    }
+    else if (x + 1 > m_scrollX + getWidth()) {
+        m_scrollX = x + 1 - getWidth();
+    }
+}
+
+
+} //namespace amgui
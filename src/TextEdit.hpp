@@ -0,0 +1,196 @@
+#ifndef AMGUI_TEXTEDIT_HPP
+#define AMGUI_TEXTEDIT_HPP
+
+
+#include "Widget.hpp"
+#include "PieceTable.hpp"
+
+
+namespace amgui {
+
+
+/**
+    Multi-line text editor, for documents of any size.
+    The text is kept in a piece table, so editing, and finding lines, takes O(log n) time;
+    only the lines within the widget and the clipping rectangle are read from it and drawn.
+    Lines do not wrap; the view scrolls to keep the cursor visible.
+    It takes input while it has the focus: characters are inserted at the cursor,
+    the arrow, home, end, page up and page down keys move the cursor, and backspace and delete erase characters.
+ */
+class TextEdit : public Widget {
+public:
+    /**
+        The constructor.
+     */
+    TextEdit();
+
+    /**
+        Returns the document.
+     */
+    const PieceTable &getDocument() const {
+        return m_document;
+    }
+
+    /**
+        Returns the text.
+     */
+    std::string getText() const {
+        return m_document.getText();
+    }
+
+    /**
+        Sets the text; the cursor is moved to the start of it.
+     */
+    void setText(const std::string &text);
+
+    /**
+        Returns the font.
+     */
+    const std::shared_ptr<ALLEGRO_FONT> &getFont() const {
+        return m_font;
+    }
+
+    /**
+        Sets the font.
+     */
+    void setFont(const std::shared_ptr<ALLEGRO_FONT> &font);
+
+    /**
+        Returns the color of the text and of the cursor.
+     */
+    const ALLEGRO_COLOR &getColor() const {
+        return m_color;
+    }
+
+    /**
+        Sets the color of the text and of the cursor.
+     */
+    void setColor(const ALLEGRO_COLOR &color);
+
+    /**
+        Returns the offset of the cursor, in bytes.
+     */
+    size_t getCursor() const {
+        return m_cursor;
+    }
+
+    /**
+        Sets the offset of the cursor, and scrolls to it.
+        @param offset offset, in bytes; it is limited to the length of the text, and moved to the start of its character.
+     */
+    void setCursor(size_t offset);
+
+    /**
+        Inserts text at the cursor, and moves the cursor after it.
+     */
+    void insertText(const std::string &text);
+
+    /**
+        Returns the vertical scroll position, in pixels from the top of the text.
+     */
+    double getScrollPosition() const {
+        return m_scrollY;
+    }
+
+    /**
+        Sets the vertical scroll position.
+        @param position position, in pixels from the top of the text;
+            it is limited to the range from 0 to the height of the text minus the height of the widget.
+     */
+    void setScrollPosition(double position);
+
+    /**
+        Returns the number of pixels scrolled for each step of the mouse wheel.
+     */
+    float getWheelStep() const {
+        return m_wheelStep;
+    }
+
+    /**
+        Sets the number of pixels scrolled for each step of the mouse wheel.
+     */
+    void setWheelStep(float step) {
+        m_wheelStep = step;
+    }
+
+    /**
+        Draws the visible lines and the cursor, then the children.
+     */
+    virtual void draw(float x, float y, bool enabled, bool highlighted, bool pushed, bool selected) override;
+
+    /**
+        Sets the focus to the widget, and moves the cursor to the given point, unless a child processes the event.
+     */
+    virtual bool leftButtonDown(int x, int y) override;
+
+    /**
+        Scrolls the text, unless a child processes the event.
+     */
+    virtual bool mouseWheel(int z, int w) override;
+
+    /**
+        Edits the text, or moves the cursor; keys used in combination with ctrl, other than home and end,
+        are left to the children and to the keyboard shortcuts.
+     */
+    virtual bool keyChar(int keycode, int unichar, int modifiers) override;
+
+    /**
+        Shows the cursor.
+     */
+    virtual bool gotFocus() override;
+
+    /**
+        Hides the cursor.
+     */
+    virtual bool lostFocus() override;
+
+private:
+    //text
+    PieceTable m_document;
+
+    //font
+    std::shared_ptr<ALLEGRO_FONT> m_font;
+
+    //color
+    ALLEGRO_COLOR m_color;
+
+    //offset of the cursor
+    size_t m_cursor;
+
+    //x coordinate kept by moving the cursor up and down; negative if there is none
+    float m_preferredX;
+
+    //scroll position
+    double m_scrollY;
+    float m_scrollX;
+
+    //pixels per wheel step
+    float m_wheelStep;
+
+    //returns the height of lines
+    float _getLineHeight() const;
+
+    //returns the offset of the previous character
+    size_t _getPrevChar(size_t offset) const;
+
+    //returns the offset of the next character
+    size_t _getNextChar(size_t offset) const;
+
+    //returns the x coordinate of an offset, relative to the start of its line
+    float _getX(size_t offset) const;
+
+    //returns the offset of the character boundary nearest to the given x coordinate in a line
+    size_t _getOffsetAt(size_t line, float x) const;
+
+    //moves the cursor to another line, keeping its x coordinate
+    void _moveCursorToLine(size_t line);
+
+    //scrolls the least needed for the cursor to be visible
+    void _scrollToCursor();
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_TEXTEDIT_HPP
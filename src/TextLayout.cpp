@@ -0,0 +1,362 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "TextLayout.hpp"
+#include "TextMetrics.hpp"
+
+
+namespace amgui {
+
+
+//value returned for invalid line indexes
+const size_t TextLayout::npos;
+
+
+//width of lines that do not wrap
+static const float _noWrap = std::numeric_limits<float>::infinity();
+
+
+//returns true if the given byte starts a utf-8 character
+static bool _isCharStart(char c) {
+    return (c & 0xc0) != 0x80;
+}
+
+
+/**
+    The constructor.
+ */
+TextLayout::TextLayout() :
+    m_width(0),
+    m_paragraphs(1, _Paragraph{std::string(), std::vector<_Line>(), 0, 0, 0, false}),
+    m_dirty(true),
+    m_naturalWidth(0),
+    m_firstLines(2, 0),
+    m_validFirstLines(1),
+    m_wrapCount(0)
+{
+}
+
+
+/**
+    Sets the font; all paragraphs are wrapped again.
+ */
+void TextLayout::setFont(const std::shared_ptr<ALLEGRO_FONT> &font) {
+    if (font == m_font) return;
+    m_font = font;
+    for(_Paragraph &paragraph : m_paragraphs) {
+        paragraph.valid = false;
+    }
+    m_dirty = true;
+}
+
+
+/**
+    Sets the width lines wrap to.
+    @param width width; if 0 or less, lines do not wrap.
+ */
+void TextLayout::setWidth(float width) {
+    width = std::max(width, 0.f);
+    if (width == m_width) return;
+    m_width = width;
+    m_dirty = true;
+}
+
+
+/**
+    Returns the text; paragraphs are separated by new lines.
+ */
+std::string TextLayout::getText() const {
+    std::string result;
+    for(size_t i = 0; i < m_paragraphs.size(); ++i) {
+        if (i > 0) {
+            result += '\n';
+        }
+        result += m_paragraphs[i].text;
+    }
+    return result;
+}
+
+
+/**
+    Sets the text; paragraphs are separated by new lines.
+ */
+void TextLayout::setText(const std::string &text) {
+    std::vector<std::string> texts;
+    for(size_t start = 0; ; ) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            texts.push_back(text.substr(start));
+            break;
+        }
+        texts.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+
+    //the paragraphs at the start and at the end which did not change are kept
+    size_t prefix = 0;
+    while (prefix < texts.size() && prefix < m_paragraphs.size() && texts[prefix] == m_paragraphs[prefix].text) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < texts.size() - prefix && suffix < m_paragraphs.size() - prefix && texts[texts.size() - 1 - suffix] == m_paragraphs[m_paragraphs.size() - 1 - suffix].text) {
+        ++suffix;
+    }
+    if (prefix + suffix == texts.size() && prefix + suffix == m_paragraphs.size()) return;
+
+    //replace the rest
+    m_paragraphs.erase(m_paragraphs.begin() + prefix, m_paragraphs.end() - suffix);
+    std::vector<_Paragraph> paragraphs;
+    paragraphs.reserve(texts.size() - prefix - suffix);
+    for(size_t i = prefix; i < texts.size() - suffix; ++i) {
+        paragraphs.push_back(_Paragraph{std::move(texts[i]), std::vector<_Line>(), 0, 0, 0, false});
+    }
+    m_paragraphs.insert(m_paragraphs.begin() + prefix, std::make_move_iterator(paragraphs.begin()), std::make_move_iterator(paragraphs.end()));
+    m_firstLines.resize(m_paragraphs.size() + 1);
+    _invalidate(prefix);
+}
+
+
+/**
+    Sets the text of a paragraph; it must not contain new lines.
+ */
+void TextLayout::setParagraph(size_t index, const std::string &text) {
+    _Paragraph &paragraph = m_paragraphs[index];
+    if (text == paragraph.text) return;
+    paragraph.text = text;
+    paragraph.valid = false;
+    m_dirty = true;
+}
+
+
+/**
+    Inserts a paragraph; it must not contain new lines.
+    @param index index of the new paragraph; it may be the number of paragraphs.
+    @param text text of the new paragraph.
+ */
+void TextLayout::insertParagraph(size_t index, const std::string &text) {
+    m_paragraphs.insert(m_paragraphs.begin() + index, _Paragraph{text, std::vector<_Line>(), 0, 0, 0, false});
+    m_firstLines.resize(m_paragraphs.size() + 1);
+    _invalidate(index);
+}
+
+
+/**
+    Removes paragraphs; the last paragraph is never removed, it is emptied instead.
+    @param index index of the first paragraph to remove.
+    @param count number of paragraphs to remove.
+ */
+void TextLayout::removeParagraphs(size_t index, size_t count/* = 1*/) {
+    count = std::min(count, m_paragraphs.size() - index);
+    if (count == 0) return;
+    if (count == m_paragraphs.size()) {
+        setParagraph(0, std::string());
+        --count;
+        ++index;
+    }
+    m_paragraphs.erase(m_paragraphs.begin() + index, m_paragraphs.begin() + index + count);
+    m_firstLines.resize(m_paragraphs.size() + 1);
+    _invalidate(index);
+}
+
+
+/**
+    Returns the height of lines.
+ */
+float TextLayout::getLineHeight() const {
+    return m_font ? (float)al_get_font_line_height(m_font.get()) : 0;
+}
+
+
+/**
+    Returns the number of lines.
+ */
+size_t TextLayout::getLineCount() const {
+    _update();
+    return m_firstLines.back();
+}
+
+
+/**
+    Returns the width of the widest paragraph, if it was not wrapped.
+ */
+float TextLayout::getNaturalWidth() const {
+    _update();
+    return m_naturalWidth;
+}
+
+
+/**
+    Returns the metrics of a line.
+    @param index index of the line; it must be less than the number of lines.
+ */
+TextLayout::Line TextLayout::getLine(size_t index) const {
+    _update();
+
+    //each paragraph has at least one line, so the first lines are in ascending order
+    size_t paragraph = std::upper_bound(m_firstLines.begin(), m_firstLines.end() - 1, index) - m_firstLines.begin() - 1;
+    const _Line &line = m_paragraphs[paragraph].lines[index - m_firstLines[paragraph]];
+    return Line{paragraph, line.offset, line.length, line.width, index * getLineHeight()};
+}
+
+
+/**
+    Returns the line at the given y coordinate, or npos if there is no line there.
+ */
+size_t TextLayout::getLineAt(float y) const {
+    float lineHeight = getLineHeight();
+    if (y < 0 || lineHeight <= 0) return npos;
+    double line = std::floor(y / lineHeight);
+    return line < getLineCount() ? (size_t)line : npos;
+}
+
+
+/**
+    Returns the index of the first line of a paragraph.
+ */
+size_t TextLayout::getFirstLine(size_t paragraph) const {
+    _update();
+    return m_firstLines[paragraph];
+}
+
+
+//wraps the paragraphs that need it, and computes the first lines
+void TextLayout::_update() const {
+    if (m_dirty) {
+        const float width = m_width > 0 ? m_width : _noWrap;
+        m_naturalWidth = 0;
+        for(size_t i = 0; i < m_paragraphs.size(); ++i) {
+            _Paragraph &paragraph = m_paragraphs[i];
+
+            //the breaks of a paragraph stay the same for the range of widths it was wrapped for
+            if (!paragraph.valid || width < paragraph.minWidth || (width >= paragraph.maxWidth && paragraph.maxWidth != _noWrap)) {
+                size_t lineCount = paragraph.lines.size();
+                _wrap(paragraph);
+                if (paragraph.lines.size() != lineCount) {
+                    m_validFirstLines = std::min(m_validFirstLines, i + 1);
+                }
+            }
+            m_naturalWidth = std::max(m_naturalWidth, paragraph.naturalWidth);
+        }
+        m_dirty = false;
+    }
+
+    for(; m_validFirstLines < m_firstLines.size(); ++m_validFirstLines) {
+        m_firstLines[m_validFirstLines] = m_firstLines[m_validFirstLines - 1] + m_paragraphs[m_validFirstLines - 1].lines.size();
+    }
+}
+
+
+//wraps a paragraph
+void TextLayout::_wrap(_Paragraph &paragraph) const {
+    ++m_wrapCount;
+    const std::string &text = paragraph.text;
+    const float width = m_width > 0 ? m_width : _noWrap;
+    paragraph.lines.clear();
+    paragraph.naturalWidth = 0;
+    paragraph.minWidth = 0;
+    paragraph.maxWidth = _noWrap;
+    paragraph.valid = true;
+
+    //without a font, there is nothing to measure
+    if (!m_font) {
+        paragraph.lines.push_back(_Line{0, text.size(), 0});
+        return;
+    }
+
+    //measure the words
+    const float spaceWidth = (float)TextMetrics::getTextWidth(m_font.get(), " ");
+    m_words.clear();
+    for(size_t pos = 0; ; ) {
+        size_t start = text.find_first_not_of(' ', pos);
+        if (start == std::string::npos) break;
+        size_t end = std::min(text.find(' ', start), text.size());
+        m_words.push_back(_Word{start - pos, start, end, _measure(text, start, end - start)});
+        paragraph.naturalWidth += (start - pos) * spaceWidth + m_words.back().width;
+        pos = end;
+    }
+
+    //place as many words as fit in each line
+    size_t lineStart = 0;
+    float lineWidth = 0;
+    bool lineHasWords = false;
+    for(const _Word &word : m_words) {
+        float extendedWidth = lineWidth + word.spaces * spaceWidth + word.width;
+
+        //the word goes to the next line; the spaces before it stay at the end of this line
+        if (lineHasWords && extendedWidth > width) {
+            paragraph.lines.push_back(_Line{lineStart, word.start - lineStart, lineWidth});
+            paragraph.minWidth = std::max(paragraph.minWidth, std::min(lineWidth, width));
+            paragraph.maxWidth = std::min(paragraph.maxWidth, extendedWidth);
+            lineStart = word.start;
+            lineWidth = 0;
+            extendedWidth = word.width;
+        }
+
+        if (extendedWidth <= width) {
+            lineWidth = extendedWidth;
+            lineHasWords = true;
+            continue;
+        }
+
+        //the word does not fit in a line of its own, so it is broken between characters
+        float lead = extendedWidth - word.width;
+        for(size_t start = word.start; ; ) {
+            //at least one character is placed in each line
+            size_t end = start + 1;
+            while (end < word.end && !_isCharStart(text[end])) ++end;
+
+            float restWidth = _measure(text, start, word.end - start);
+            if (lead + restWidth <= width || end == word.end) {
+                lineWidth = lead + restWidth;
+                lineHasWords = true;
+                break;
+            }
+
+            //find the longest part that fits, between a part that fits and one that does not
+            size_t next = word.end;
+            for(;;) {
+                size_t middle = end + (next - end) / 2;
+                while (middle > end && !_isCharStart(text[middle])) --middle;
+                if (middle == end) {
+                    for(++middle; middle < next && !_isCharStart(text[middle]); ++middle);
+                    if (middle == next) break;
+                }
+                if (lead + _measure(text, start, middle - start) <= width) {
+                    end = middle;
+                }
+                else {
+                    next = middle;
+                }
+            }
+
+            float partWidth = lead + _measure(text, start, end - start);
+            paragraph.lines.push_back(_Line{lineStart, end - lineStart, partWidth});
+            paragraph.minWidth = std::max(paragraph.minWidth, std::min(partWidth, width));
+            paragraph.maxWidth = std::min(paragraph.maxWidth, lead + _measure(text, start, next - start));
+
+            lineStart = start = end;
+            lead = 0;
+        }
+    }
+
+    //the last line takes the rest of the paragraph, including the spaces at its end
+    paragraph.lines.push_back(_Line{lineStart, text.size() - lineStart, lineWidth});
+    paragraph.minWidth = std::max(paragraph.minWidth, std::min(lineWidth, width));
+}
+
+
+//measures part of a paragraph
+float TextLayout::_measure(const std::string &text, size_t offset, size_t length) const {
+    m_buffer.assign(text, offset, length);
+    return (float)TextMetrics::getTextWidth(m_font.get(), m_buffer);
+}
+
+
+//marks the first lines as invalid from the given paragraph onwards
+void TextLayout::_invalidate(size_t index) {
+    m_validFirstLines = std::min(m_validFirstLines, index + 1);
+    m_dirty = true;
+}
+
+
+} //namespace amgui
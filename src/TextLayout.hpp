@@ -0,0 +1,241 @@
+#ifndef AMGUI_TEXTLAYOUT_HPP
+#define AMGUI_TEXTLAYOUT_HPP
+
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+
+
+namespace amgui {
+
+
+/**
+    Lays out text in lines that wrap to a width.
+    The text is split into paragraphs at new lines; the line breaks of each paragraph are kept,
+    so as that only the paragraphs affected by a change are wrapped again:
+    an edit wraps the paragraphs it changes, and a new width wraps the paragraphs whose breaks it moves.
+    Lines break at spaces; words longer than the width break between characters.
+    All lines have the height of the font, so the line at a given y coordinate is found without a pass over the text.
+    The layout is updated lazily, when its lines are queried.
+ */
+class TextLayout {
+public:
+    /**
+        Value returned for invalid line indexes.
+     */
+    static const size_t npos = (size_t)-1;
+
+    /**
+        Metrics of a line.
+     */
+    struct Line {
+        ///index of the paragraph of the line.
+        size_t paragraph;
+
+        ///offset of the line in the paragraph, in bytes.
+        size_t offset;
+
+        ///length of the line, in bytes, including the spaces it ends with.
+        size_t length;
+
+        ///width of the line, without the spaces it ends with.
+        float width;
+
+        ///y coordinate of the top of the line.
+        float y;
+    };
+
+    /**
+        The constructor.
+     */
+    TextLayout();
+
+    /**
+        Returns the font.
+     */
+    const std::shared_ptr<ALLEGRO_FONT> &getFont() const {
+        return m_font;
+    }
+
+    /**
+        Sets the font; all paragraphs are wrapped again.
+     */
+    void setFont(const std::shared_ptr<ALLEGRO_FONT> &font);
+
+    /**
+        Returns the width lines wrap to.
+     */
+    float getWidth() const {
+        return m_width;
+    }
+
+    /**
+        Sets the width lines wrap to.
+        @param width width; if 0 or less, lines do not wrap.
+     */
+    void setWidth(float width);
+
+    /**
+        Returns the text; paragraphs are separated by new lines.
+     */
+    std::string getText() const;
+
+    /**
+        Sets the text; paragraphs are separated by new lines.
+        The paragraphs at the start and at the end of the text that are the same as before keep their lines,
+        so setting the text after an edit wraps only the paragraphs the edit changed.
+     */
+    void setText(const std::string &text);
+
+    /**
+        Returns the number of paragraphs; there is at least one.
+     */
+    size_t getParagraphCount() const {
+        return m_paragraphs.size();
+    }
+
+    /**
+        Returns the text of a paragraph.
+     */
+    const std::string &getParagraph(size_t index) const {
+        return m_paragraphs[index].text;
+    }
+
+    /**
+        Sets the text of a paragraph; it must not contain new lines.
+     */
+    void setParagraph(size_t index, const std::string &text);
+
+    /**
+        Inserts a paragraph; it must not contain new lines.
+        @param index index of the new paragraph; it may be the number of paragraphs.
+        @param text text of the new paragraph.
+     */
+    void insertParagraph(size_t index, const std::string &text);
+
+    /**
+        Removes paragraphs; the last paragraph is never removed, it is emptied instead.
+        @param index index of the first paragraph to remove.
+        @param count number of paragraphs to remove.
+     */
+    void removeParagraphs(size_t index, size_t count = 1);
+
+    /**
+        Returns the height of lines.
+     */
+    float getLineHeight() const;
+
+    /**
+        Returns the number of lines.
+     */
+    size_t getLineCount() const;
+
+    /**
+        Returns the height of all lines.
+     */
+    float getHeight() const {
+        return getLineCount() * getLineHeight();
+    }
+
+    /**
+        Returns the width of the widest paragraph, if it was not wrapped.
+     */
+    float getNaturalWidth() const;
+
+    /**
+        Returns the metrics of a line.
+        @param index index of the line; it must be less than the number of lines.
+     */
+    Line getLine(size_t index) const;
+
+    /**
+        Returns the line at the given y coordinate, or npos if there is no line there.
+     */
+    size_t getLineAt(float y) const;
+
+    /**
+        Returns the index of the first line of a paragraph.
+     */
+    size_t getFirstLine(size_t paragraph) const;
+
+    /**
+        Returns the number of times paragraphs were wrapped, for measuring the cost of changes.
+     */
+    size_t getWrapCount() const {
+        return m_wrapCount;
+    }
+
+private:
+    //line of a paragraph
+    struct _Line {
+        size_t offset;
+        size_t length;
+        float width;
+    };
+
+    //word of a paragraph, and the number of spaces before it
+    struct _Word {
+        size_t spaces;
+        size_t start;
+        size_t end;
+        float width;
+    };
+
+    //paragraph and its lines; the lines are valid for widths from minWidth up to, but excluding, maxWidth
+    struct _Paragraph {
+        std::string text;
+        std::vector<_Line> lines;
+        float naturalWidth;
+        float minWidth;
+        float maxWidth;
+        bool valid;
+    };
+
+    //font
+    std::shared_ptr<ALLEGRO_FONT> m_font;
+
+    //width
+    float m_width;
+
+    //paragraphs; they are wrapped when the layout is queried
+    mutable std::vector<_Paragraph> m_paragraphs;
+
+    //true if some paragraphs may need to be wrapped
+    mutable bool m_dirty;
+
+    //width of the widest paragraph, if it was not wrapped
+    mutable float m_naturalWidth;
+
+    //index of the first line of each paragraph, plus the number of lines at the end;
+    //the entries after the first paragraph that changed are computed when the layout is queried
+    mutable std::vector<size_t> m_firstLines;
+    mutable size_t m_validFirstLines;
+
+    //number of times paragraphs were wrapped
+    mutable size_t m_wrapCount;
+
+    //buffers for measuring parts of the text
+    mutable std::string m_buffer;
+    mutable std::vector<_Word> m_words;
+
+    //wraps the paragraphs that need it, and computes the first lines
+    void _update() const;
+
+    //wraps a paragraph
+    void _wrap(_Paragraph &paragraph) const;
+
+    //measures part of a paragraph
+    float _measure(const std::string &text, size_t offset, size_t length) const;
+
+    //marks the first lines as invalid from the given paragraph onwards
+    void _invalidate(size_t index);
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_TEXTLAYOUT_HPP
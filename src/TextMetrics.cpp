@@ -0,0 +1,217 @@
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include "TextMetrics.hpp"
+#include "Mutex.hpp"
+
+
+namespace amgui {
+
+
+//number of independently locked parts of the cache
+static const size_t _shardCount = 16;
+
+
+//default capacity
+static const size_t _defaultCapacity = 256 * 1024;
+
+
+//a measurement
+struct _Entry {
+    const ALLEGRO_FONT *font;
+    std::string text;
+    bool hasWidth;
+    bool hasDimensions;
+    int width;
+    TextMetrics::Dimensions dimensions;
+};
+
+
+//part of the cache
+struct _Shard {
+    Mutex mutex;
+    std::unordered_multimap<uint64_t, _Entry> entries;
+};
+
+
+//the cache
+static _Shard _shards[_shardCount];
+
+
+//capacity
+static std::atomic<size_t> _capacity(_defaultCapacity);
+
+
+//allegro fonts are not thread safe, so text is measured by one thread at a time
+static Mutex _measureMutex;
+
+
+//FNV-1a hash of a font and text
+static uint64_t _hash(const ALLEGRO_FONT *font, const char *text) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&font);
+    for(size_t i = 0; i < sizeof(font); ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    for(const unsigned char *c = reinterpret_cast<const unsigned char *>(text); *c; ++c) {
+        hash = (hash ^ *c) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+
+//returns the shard of a hash
+static _Shard &_getShard(uint64_t hash) {
+    return _shards[(hash >> 32) % _shardCount];
+}
+
+
+//finds a measurement; the shard must be locked
+static _Entry *_find(_Shard &shard, uint64_t hash, const ALLEGRO_FONT *font, const char *text) {
+    auto range = shard.entries.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it) {
+        if (it->second.font == font && it->second.text == text) {
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+
+//finds or adds a measurement; the shard must be locked
+static _Entry &_findOrAdd(_Shard &shard, uint64_t hash, const ALLEGRO_FONT *font, const char *text) {
+    _Entry *entry = _find(shard, hash, font, text);
+    if (entry) return *entry;
+
+    //a full shard is emptied
+    if (shard.entries.size() >= std::max(_capacity.load(std::memory_order_relaxed) / _shardCount, (size_t)1)) {
+        shard.entries.clear();
+    }
+
+    return shard.entries.insert(std::make_pair(hash, _Entry{font, text, false, false, 0, TextMetrics::Dimensions{0, 0, 0, 0}}))->second;
+}
+
+
+/**
+    Returns the width of text, as al_get_text_width does.
+ */
+int TextMetrics::getTextWidth(const ALLEGRO_FONT *font, const char *text) {
+    if (!font || !text) return 0;
+
+    uint64_t hash = _hash(font, text);
+    _Shard &shard = _getShard(hash);
+    {
+        MutexLock lock(shard.mutex);
+        _Entry *entry = _find(shard, hash, font, text);
+        if (entry && entry->hasWidth) return entry->width;
+    }
+
+    int width;
+    {
+        MutexLock lock(_measureMutex);
+        width = al_get_text_width(font, text);
+    }
+
+    MutexLock lock(shard.mutex);
+    _Entry &entry = _findOrAdd(shard, hash, font, text);
+    entry.width = width;
+    entry.hasWidth = true;
+    return width;
+}
+
+
+/**
+    Returns the dimensions of text, as al_get_text_dimensions does.
+ */
+TextMetrics::Dimensions TextMetrics::getTextDimensions(const ALLEGRO_FONT *font, const char *text) {
+    if (!font || !text) return Dimensions{0, 0, 0, 0};
+
+    uint64_t hash = _hash(font, text);
+    _Shard &shard = _getShard(hash);
+    {
+        MutexLock lock(shard.mutex);
+        _Entry *entry = _find(shard, hash, font, text);
+        if (entry && entry->hasDimensions) return entry->dimensions;
+    }
+
+    Dimensions dimensions;
+    {
+        MutexLock lock(_measureMutex);
+        al_get_text_dimensions(font, text, &dimensions.x, &dimensions.y, &dimensions.width, &dimensions.height);
+    }
+
+    MutexLock lock(shard.mutex);
+    _Entry &entry = _findOrAdd(shard, hash, font, text);
+    entry.dimensions = dimensions;
+    entry.hasDimensions = true;
+    return dimensions;
+}
+
+
+/**
+    Removes the measurements of a font.
+ */
+void TextMetrics::releaseFont(const ALLEGRO_FONT *font) {
+    for(_Shard &shard : _shards) {
+        MutexLock lock(shard.mutex);
+        for(auto it = shard.entries.begin(); it != shard.entries.end(); ) {
+            if (it->second.font == font) {
+                it = shard.entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+}
+
+
+/**
+    Removes all measurements.
+ */
+void TextMetrics::clear() {
+    for(_Shard &shard : _shards) {
+        MutexLock lock(shard.mutex);
+        shard.entries.clear();
+    }
+}
+
+
+/**
+    Returns the number of measurements in the cache.
+ */
+size_t TextMetrics::size() {
+    size_t result = 0;
+    for(_Shard &shard : _shards) {
+        MutexLock lock(shard.mutex);
+        result += shard.entries.size();
+    }
+    return result;
+}
+
+
+/**
+    Returns the maximum number of measurements.
+ */
+size_t TextMetrics::getCapacity() {
+    return _capacity.load(std::memory_order_relaxed);
+}
+
+
+/**
+    Sets the maximum number of measurements.
+ */
+void TextMetrics::setCapacity(size_t capacity) {
+    _capacity.store(capacity, std::memory_order_relaxed);
+    size_t limit = std::max(capacity / _shardCount, (size_t)1);
+    for(_Shard &shard : _shards) {
+        MutexLock lock(shard.mutex);
+        if (shard.entries.size() > limit) {
+            shard.entries.clear();
+        }
+    }
+}
+
+
+} //namespace amgui
@@ -0,0 +1,96 @@
+#ifndef AMGUI_TEXTMETRICS_HPP
+#define AMGUI_TEXTMETRICS_HPP
+
+
+#include <string>
+#include <cstdint>
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+
+
+namespace amgui {
+
+
+/**
+    Cache of text measurements, for layout code that measures the same strings again and again.
+    Measurements are identified by font and text; looking up a measurement does not allocate memory.
+    The cache can be used from any thread, e.g. from pack() and layout() running on the layout thread pool.
+    The measurements of a font are removed when the font is released;
+    fonts loaded by the resource cache are released automatically, other fonts must be released with releaseFont().
+    When the cache holds more measurements than its capacity, some of them are removed.
+ */
+class TextMetrics {
+public:
+    /**
+        The dimensions of text, as returned by al_get_text_dimensions.
+     */
+    struct Dimensions {
+        ///left offset.
+        int x;
+
+        ///top offset.
+        int y;
+
+        ///width.
+        int width;
+
+        ///height.
+        int height;
+    };
+
+    /**
+        Returns the width of text, as al_get_text_width does.
+     */
+    static int getTextWidth(const ALLEGRO_FONT *font, const char *text);
+
+    /**
+        Returns the width of text, as al_get_text_width does.
+     */
+    static int getTextWidth(const ALLEGRO_FONT *font, const std::string &text) {
+        return getTextWidth(font, text.c_str());
+    }
+
+    /**
+        Returns the dimensions of text, as al_get_text_dimensions does.
+     */
+    static Dimensions getTextDimensions(const ALLEGRO_FONT *font, const char *text);
+
+    /**
+        Returns the dimensions of text, as al_get_text_dimensions does.
+     */
+    static Dimensions getTextDimensions(const ALLEGRO_FONT *font, const std::string &text) {
+        return getTextDimensions(font, text.c_str());
+    }
+
+    /**
+        Removes the measurements of a font; it must be called before the font is destroyed,
+        unless the font was loaded by the resource cache.
+     */
+    static void releaseFont(const ALLEGRO_FONT *font);
+
+    /**
+        Removes all measurements.
+     */
+    static void clear();
+
+    /**
+        Returns the number of measurements in the cache.
+     */
+    static size_t size();
+
+    /**
+        Returns the maximum number of measurements.
+     */
+    static size_t getCapacity();
+
+    /**
+        Sets the maximum number of measurements; measurements are removed as needed.
+     */
+    static void setCapacity(size_t capacity);
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_TEXTMETRICS_HPP
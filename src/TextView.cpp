@@ -0,0 +1,169 @@
+#include <cmath>
+#include <algorithm>
+#include "TextView.hpp"
+#include "PrimitiveBatch.hpp"
+
+
+namespace amgui {
+
+
+//default pixels per wheel step
+static const float _defaultWheelStep = 48;
+
+
+/**
+    The constructor.
+ */
+TextView::TextView() :
+    m_color(al_map_rgb(0, 0, 0)),
+    m_align(AlignStart),
+    m_scrollPosition(0),
+    m_wheelStep(_defaultWheelStep)
+{
+    //the text is measured without wrapping, until the widget is given a width
+    setSize(0, 0);
+}
+
+
+/**
+    Sets the text.
+ */
+void TextView::setText(const std::string &text) {
+    m_textLayout.setText(text);
+    _textChanged();
+}
+
+
+/**
+    Sets the font.
+ */
+void TextView::setFont(const std::shared_ptr<ALLEGRO_FONT> &font) {
+    if (font == m_textLayout.getFont()) return;
+    m_textLayout.setFont(font);
+    _textChanged();
+}
+
+
+/**
+    Sets the color of the text.
+ */
+void TextView::setColor(const ALLEGRO_COLOR &color) {
+    m_color = color;
+    invalidate();
+}
+
+
+/**
+    Sets the horizontal alignment of lines.
+ */
+void TextView::setAlign(Align align) {
+    if (align == m_align) return;
+    m_align = align;
+    invalidate();
+}
+
+
+/**
+    Sets the vertical scroll position.
+ */
+void TextView::setScrollPosition(double position) {
+    position = std::max(std::min(position, (double)m_textLayout.getHeight() - getHeight()), 0.0);
+    if (position == m_scrollPosition) return;
+    m_scrollPosition = position;
+    invalidate();
+}
+
+
+/**
+    Draws the visible lines, then the children.
+ */
+void TextView::draw(float x, float y, bool enabled, bool highlighted, bool pushed, bool selected) {
+    const std::shared_ptr<ALLEGRO_FONT> &font = m_textLayout.getFont();
+    const float lineHeight = m_textLayout.getLineHeight();
+    if (font && lineHeight > 0) {
+        const float left = x + getX(), top = y + getY();
+
+        //lines are clipped to the widget
+        int clipX, clipY, clipWidth, clipHeight;
+        al_get_clipping_rectangle(&clipX, &clipY, &clipWidth, &clipHeight);
+        Rect clip = Rect(clipX, clipY, clipX + clipWidth - 1, clipY + clipHeight - 1).getIntersection(Rect(left, top, left + getWidth() - 1, top + getHeight() - 1));
+        if (!clip.isEmpty()) {
+            PrimitiveBatch::getCurrent()->flush();
+            al_set_clipping_rectangle((int)std::floor(clip.getLeft()), (int)std::floor(clip.getTop()), (int)std::ceil(clip.getRight()) - (int)std::floor(clip.getLeft()) + 1, (int)std::ceil(clip.getBottom()) - (int)std::floor(clip.getTop()) + 1);
+
+            //only the lines within the clipping rectangle are drawn
+            const double firstY = m_scrollPosition + (clip.getTop() - top);
+            const double lastY = m_scrollPosition + (clip.getBottom() - top);
+            const size_t lineCount = m_textLayout.getLineCount();
+            const size_t first = (size_t)std::max(std::floor(firstY / lineHeight), 0.0);
+            const size_t end = std::min((size_t)std::max(std::floor(lastY / lineHeight) + 1, 0.0), lineCount);
+            for(size_t index = first; index < end; ++index) {
+                TextLayout::Line line = m_textLayout.getLine(index);
+                float lineX = left;
+                if (m_align == AlignCenter) {
+                    lineX += std::floor((getWidth() - line.width) / 2);
+                }
+                else if (m_align == AlignEnd) {
+                    lineX += getWidth() - line.width;
+                }
+                ALLEGRO_USTR_INFO info;
+                const std::string &text = m_textLayout.getParagraph(line.paragraph);
+                al_draw_ustr(font.get(), m_color, lineX, (float)(top + line.y - m_scrollPosition), 0, al_ref_buffer(&info, text.data() + line.offset, line.length));
+            }
+
+            al_set_clipping_rectangle(clipX, clipY, clipWidth, clipHeight);
+        }
+    }
+
+    Widget::draw(x, y, enabled, highlighted, pushed, selected);
+}
+
+
+/**
+    Scrolls the text, unless a child processes the event.
+ */
+bool TextView::mouseWheel(int z, int w) {
+    if (Widget::mouseWheel(z, w)) return true;
+    if (!getMouseWheelDeltaZ()) return false;
+    setScrollPosition(m_scrollPosition - getMouseWheelDeltaZ() * m_wheelStep);
+    return true;
+}
+
+
+/**
+    Measures the text.
+ */
+void TextView::pack() {
+    Widget::pack();
+    m_textLayout.setWidth(getWidth());
+    setMeasuredSize(std::ceil(m_textLayout.getNaturalWidth()), m_textLayout.getHeight());
+}
+
+
+/**
+    Wraps the text to the width of the widget.
+ */
+void TextView::layout() {
+    m_textLayout.setWidth(getWidth());
+
+    //the height for the new width is measured, and given to the parent, by the next pass
+    if (m_textLayout.getHeight() != getMeasuredHeight()) {
+        invalidatePack();
+    }
+
+    //the text may have become shorter, or the widget taller
+    m_scrollPosition = std::max(std::min(m_scrollPosition, (double)m_textLayout.getHeight() - getHeight()), 0.0);
+
+    Widget::layout();
+}
+
+
+//marks the widget as needing to be measured, laid out and drawn, after the text changed
+void TextView::_textChanged() {
+    invalidatePack();
+    invalidateLayout();
+    invalidate();
+}
+
+
+} //namespace amgui
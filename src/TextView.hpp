@@ -0,0 +1,156 @@
+#ifndef AMGUI_TEXTVIEW_HPP
+#define AMGUI_TEXTVIEW_HPP
+
+
+#include "Widget.hpp"
+#include "TextLayout.hpp"
+#include "Align.hpp"
+
+
+namespace amgui {
+
+
+/**
+    Multi-line text that wraps to the width of the widget.
+    The text is laid out by a text layout, so changing the text or the width wraps only the paragraphs affected;
+    only the lines within the widget and the clipping rectangle are drawn.
+    If the text is taller than the widget, it can be scrolled.
+ */
+class TextView : public Widget {
+public:
+    /**
+        The constructor.
+     */
+    TextView();
+
+    /**
+        Returns the text layout.
+     */
+    const TextLayout &getTextLayout() const {
+        return m_textLayout;
+    }
+
+    /**
+        Returns the text.
+     */
+    std::string getText() const {
+        return m_textLayout.getText();
+    }
+
+    /**
+        Sets the text; paragraphs are separated by new lines.
+        Only the paragraphs which changed are wrapped again.
+     */
+    void setText(const std::string &text);
+
+    /**
+        Returns the font.
+     */
+    const std::shared_ptr<ALLEGRO_FONT> &getFont() const {
+        return m_textLayout.getFont();
+    }
+
+    /**
+        Sets the font.
+     */
+    void setFont(const std::shared_ptr<ALLEGRO_FONT> &font);
+
+    /**
+        Returns the color of the text.
+     */
+    const ALLEGRO_COLOR &getColor() const {
+        return m_color;
+    }
+
+    /**
+        Sets the color of the text.
+     */
+    void setColor(const ALLEGRO_COLOR &color);
+
+    /**
+        Returns the horizontal alignment of lines.
+     */
+    Align getAlign() const {
+        return m_align;
+    }
+
+    /**
+        Sets the horizontal alignment of lines; AlignStretch is the same as AlignStart.
+     */
+    void setAlign(Align align);
+
+    /**
+        Returns the vertical scroll position, in pixels from the top of the text.
+     */
+    double getScrollPosition() const {
+        return m_scrollPosition;
+    }
+
+    /**
+        Sets the vertical scroll position.
+        @param position position, in pixels from the top of the text;
+            it is limited to the range from 0 to the height of the text minus the height of the widget.
+     */
+    void setScrollPosition(double position);
+
+    /**
+        Returns the number of pixels scrolled for each step of the mouse wheel.
+     */
+    float getWheelStep() const {
+        return m_wheelStep;
+    }
+
+    /**
+        Sets the number of pixels scrolled for each step of the mouse wheel.
+     */
+    void setWheelStep(float step) {
+        m_wheelStep = step;
+    }
+
+    /**
+        Draws the visible lines, then the children.
+     */
+    virtual void draw(float x, float y, bool enabled, bool highlighted, bool pushed, bool selected) override;
+
+    /**
+        Scrolls the text, unless a child processes the event.
+     */
+    virtual bool mouseWheel(int z, int w) override;
+
+    /**
+        Measures the text: the width it needs without wrapping, and the height it needs at the current width.
+     */
+    virtual void pack() override;
+
+    /**
+        Wraps the text to the width of the widget.
+        If that changes the height of the text, the widget is marked as needing to be packed,
+        so as that the next pass gives the new height to the parent.
+     */
+    virtual void layout() override;
+
+private:
+    //text layout
+    TextLayout m_textLayout;
+
+    //color
+    ALLEGRO_COLOR m_color;
+
+    //alignment
+    Align m_align;
+
+    //scroll position
+    double m_scrollPosition;
+
+    //pixels per wheel step
+    float m_wheelStep;
+
+    //marks the widget as needing to be measured, laid out and drawn, after the text changed
+    void _textChanged();
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_TEXTVIEW_HPP
@@ -0,0 +1,201 @@
+#include <algorithm>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include "ThreadPool.hpp"
+
+
+namespace amgui {
+
+
+//number of tasks per thread a parallelFor is split into, so as that threads that finish early can steal work
+static const size_t _tasksPerThread = 4;
+
+
+//pool and queue of the current worker thread;
+//gcc's __thread is used, since mingw 4.7 does not support thread_local
+static __thread const ThreadPool *_currentPool = nullptr;
+static __thread size_t _currentQueue = 0;
+
+
+/**
+    The constructor.
+    @param threads number of worker threads.
+ */
+ThreadPool::ThreadPool(size_t threads/* = getDefaultThreadCount()*/) :
+    m_queueCount(threads + 1),
+    m_queues(new _Queue[threads + 1]),
+    m_queued(0),
+    m_condition(al_create_cond()),
+    m_stop(false)
+{
+    //the workers are not moved once their threads start, since the threads point to them
+    m_threads.reserve(threads);
+    for(size_t i = 0; i < threads; ++i) {
+        m_threads.push_back(_Worker{this, i, nullptr});
+    }
+
+    //a thread that cannot be created leaves its queue unused
+    for(auto it = m_threads.begin(); it != m_threads.end(); ) {
+        it->thread = al_create_thread(&ThreadPool::_threadProc, &*it);
+        it = it->thread ? std::next(it) : m_threads.erase(it);
+    }
+    for(_Worker &worker : m_threads) {
+        al_start_thread(worker.thread);
+    }
+}
+
+
+/**
+    The destructor.
+    Stops the worker threads.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        MutexLock lock(m_mutex);
+        m_stop = true;
+    }
+    al_broadcast_cond(m_condition);
+    for(_Worker &worker : m_threads) {
+        al_join_thread(worker.thread, nullptr);
+        al_destroy_thread(worker.thread);
+    }
+    al_destroy_cond(m_condition);
+}
+
+
+/**
+    Returns one less than the number of hardware threads, or 0 if that is unknown.
+ */
+size_t ThreadPool::getDefaultThreadCount() {
+    //allegro 5.0 does not tell the number of processors
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long count = info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 1 ? count - 1 : 0;
+}
+
+
+/**
+    Invokes a function for each index from 0 to count - 1, in parallel, and waits for all invocations to finish.
+    @param count number of indexes.
+    @param function function to invoke.
+ */
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &function) {
+    if (count == 0) return;
+
+    //without workers, or for a single index, there is nothing to share
+    if (m_threads.empty() || count == 1) {
+        for(size_t i = 0; i < count; ++i) {
+            function(i);
+        }
+        return;
+    }
+
+    size_t tasks = std::min(count, (m_threads.size() + 1) * _tasksPerThread);
+    _Group group;
+    group.function = &function;
+    group.pending.store(tasks, std::memory_order_relaxed);
+
+    //the count is raised before the tasks are queued, so as that it never drops below the number of queued tasks
+    size_t queue = _getQueue();
+    m_queued.fetch_add(tasks, std::memory_order_acq_rel);
+    {
+        MutexLock lock(m_queues[queue].mutex);
+        for(size_t i = 0; i < tasks; ++i) {
+            m_queues[queue].tasks.push_back(_Task{&group, count * i / tasks, count * (i + 1) / tasks});
+        }
+    }
+
+    //wake up the idle workers
+    {
+        MutexLock lock(m_mutex);
+    }
+    al_broadcast_cond(m_condition);
+
+    //help until the work is done; the tasks of this group are at the back of the queue, so they are run first
+    while (group.pending.load(std::memory_order_acquire) > 0) {
+        if (!_runTask(queue)) {
+            al_rest(0);
+        }
+    }
+}
+
+
+//returns the queue of the current thread
+size_t ThreadPool::_getQueue() const {
+    return _currentPool == this ? _currentQueue : m_queueCount - 1;
+}
+
+
+//runs a task from the given queue, or one stolen from another queue; returns false if there was none
+bool ThreadPool::_runTask(size_t queue) {
+    _Task task;
+    bool found = false;
+
+    //the newest task of the own queue
+    {
+        MutexLock lock(m_queues[queue].mutex);
+        if (!m_queues[queue].tasks.empty()) {
+            task = m_queues[queue].tasks.back();
+            m_queues[queue].tasks.pop_back();
+            found = true;
+        }
+    }
+
+    //else the oldest task of another queue
+    for(size_t i = 1; !found && i < m_queueCount; ++i) {
+        _Queue &victim = m_queues[(queue + i) % m_queueCount];
+        MutexLock lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found) return false;
+    m_queued.fetch_sub(1, std::memory_order_acq_rel);
+
+    //the group may be destroyed as soon as its last task is done, so it is not accessed afterwards
+    for(size_t i = task.begin; i < task.end; ++i) {
+        (*task.group->function)(i);
+    }
+    task.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+
+//the worker thread function
+void ThreadPool::_work(size_t queue) {
+    _currentPool = this;
+    _currentQueue = queue;
+    for(;;) {
+        if (_runTask(queue)) continue;
+        MutexLock lock(m_mutex);
+        while (!m_stop && m_queued.load(std::memory_order_acquire) == 0) {
+            al_wait_cond(m_condition, m_mutex.get());
+        }
+        if (m_stop) return;
+    }
+}
+
+
+//the allegro thread function; the argument is the worker
+void *ThreadPool::_threadProc(ALLEGRO_THREAD *thread, void *arg) {
+    _Worker *worker = static_cast<_Worker *>(arg);
+    worker->pool->_work(worker->queue);
+    return nullptr;
+}
+
+
+} //namespace amgui
@@ -0,0 +1,127 @@
+#ifndef AMGUI_THREADPOOL_HPP
+#define AMGUI_THREADPOOL_HPP
+
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <allegro5/allegro.h>
+#include "Mutex.hpp"
+
+
+namespace amgui {
+
+
+/**
+    Pool of worker threads that share work by stealing it from each other.
+    Each thread, including any thread that waits for work it submitted, has its own queue of tasks;
+    it takes tasks from the back of its own queue, and, when that is empty, from the front of the queues of other threads.
+    Tasks may submit work themselves; the thread running them then helps with that work while it waits for it.
+ */
+class ThreadPool {
+public:
+    /**
+        The constructor.
+        @param threads number of worker threads; the thread that submits work also runs tasks while it waits,
+            so the default is one less than the number of hardware threads.
+     */
+    ThreadPool(size_t threads = getDefaultThreadCount());
+
+    /**
+        The copy constructor is deleted.
+     */
+    ThreadPool(const ThreadPool &pool) = delete;
+
+    /**
+        The destructor.
+        Stops the worker threads; there must be no work in progress.
+     */
+    ~ThreadPool();
+
+    /**
+        The copy assignment is deleted.
+     */
+    ThreadPool &operator = (const ThreadPool &pool) = delete;
+
+    /**
+        Returns one less than the number of hardware threads, or 0 if that is unknown.
+     */
+    static size_t getDefaultThreadCount();
+
+    /**
+        Returns the number of worker threads.
+     */
+    size_t getThreadCount() const {
+        return m_threads.size();
+    }
+
+    /**
+        Invokes a function for each index from 0 to count - 1, in parallel, and waits for all invocations to finish.
+        The indexes are split into ranges, which become tasks of the pool.
+        @param count number of indexes.
+        @param function function to invoke.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)> &function);
+
+private:
+    //work submitted by a call to parallelFor
+    struct _Group {
+        const std::function<void(size_t)> *function;
+        std::atomic<size_t> pending;
+    };
+
+    //range of indexes of a group
+    struct _Task {
+        _Group *group;
+        size_t begin;
+        size_t end;
+    };
+
+    //tasks of a thread
+    struct _Queue {
+        Mutex mutex;
+        std::deque<_Task> tasks;
+    };
+
+    //a worker thread and its queue
+    struct _Worker {
+        ThreadPool *pool;
+        size_t queue;
+        ALLEGRO_THREAD *thread;
+    };
+
+    //worker threads
+    std::vector<_Worker> m_threads;
+
+    //one queue per worker thread, plus one for the threads outside of the pool
+    size_t m_queueCount;
+    std::unique_ptr<_Queue[]> m_queues;
+
+    //number of tasks in the queues
+    std::atomic<size_t> m_queued;
+
+    //idle workers wait on this
+    Mutex m_mutex;
+    ALLEGRO_COND *m_condition;
+    bool m_stop;
+
+    //returns the queue of the current thread
+    size_t _getQueue() const;
+
+    //runs a task from the given queue, or one stolen from another queue; returns false if there was none
+    bool _runTask(size_t queue);
+
+    //the worker thread function
+    void _work(size_t queue);
+
+    //the allegro thread function; the argument is the worker
+    static void *_threadProc(ALLEGRO_THREAD *thread, void *arg);
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_THREADPOOL_HPP
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include "TimerWheel.hpp"
+
+
+namespace amgui {
+
+
+//constants used by reference
+const uint32_t TimerWheel::maxDelay;
+const uint32_t TimerWheel::_nil;
+
+
+/**
+    The constructor.
+ */
+TimerWheel::TimerWheel() :
+    m_time(0),
+    m_size(0),
+    m_free(_nil)
+{
+    std::fill(m_lists, m_lists + _levels * _slots + 1, _nil);
+}
+
+
+/**
+    Schedules a callback.
+    @param owner owner of the callback.
+    @param delay number of ticks after which the callback is invoked; at least 1 tick, at most maxDelay ticks.
+    @param callback callback to invoke.
+    @return id of the scheduled callback.
+ */
+TimerWheel::Id TimerWheel::schedule(const void *owner, uint32_t delay, const Callback &callback) {
+    //get an entry
+    uint32_t index;
+    if (m_free != _nil) {
+        index = m_free;
+        m_free = m_entries[index].next;
+    }
+    else {
+        index = (uint32_t)m_entries.size();
+        m_entries.push_back(_Entry{0, nullptr, Callback(), 1, _nil, _nil, _nil, _nil, _nil});
+    }
+
+    _Entry &entry = m_entries[index];
+    entry.time = m_time + std::min(std::max(delay, (uint32_t)1), maxDelay);
+    entry.owner = owner;
+    entry.callback = callback;
+
+    //add the entry to the entries of the owner
+    auto it = m_owners.find(owner);
+    entry.ownerPrev = _nil;
+    entry.ownerNext = it != m_owners.end() ? it->second : _nil;
+    if (it != m_owners.end()) {
+        m_entries[it->second].ownerPrev = index;
+        it->second = index;
+    }
+    else {
+        m_owners[owner] = index;
+    }
+
+    _place(index);
+    ++m_size;
+    return ((Id)entry.generation << 32) | index;
+}
+
+
+/**
+    Cancels a scheduled callback.
+    @param id id of the callback.
+    @return true if the callback was cancelled, false if it was already invoked or cancelled.
+ */
+bool TimerWheel::cancel(Id id) {
+    if (!_isScheduled(id)) return false;
+    _release((uint32_t)id);
+    return true;
+}
+
+
+/**
+    Returns the owner of a scheduled callback.
+    @param id id of the callback.
+    @return the owner, or null if the callback was already invoked or cancelled.
+ */
+const void *TimerWheel::getOwner(Id id) const {
+    return _isScheduled(id) ? m_entries[(uint32_t)id].owner : nullptr;
+}
+
+
+/**
+    Cancels all the callbacks of the given owner.
+ */
+void TimerWheel::cancelOwner(const void *owner) {
+    auto it = m_owners.find(owner);
+    while (it != m_owners.end()) {
+        _release(it->second);
+        it = m_owners.find(owner);
+    }
+}
+
+
+/**
+    Cancels all the callbacks of the owners for which the given function returns true.
+ */
+void TimerWheel::cancelOwners(const std::function<bool(const void *)> &predicate) {
+    std::vector<const void *> owners;
+    for(const auto &owner : m_owners) {
+        if (predicate(owner.first)) {
+            owners.push_back(owner.first);
+        }
+    }
+    for(const void *owner : owners) {
+        cancelOwner(owner);
+    }
+}
+
+
+/**
+    Cancels all the callbacks.
+ */
+void TimerWheel::clear() {
+    while (!m_owners.empty()) {
+        cancelOwner(m_owners.begin()->first);
+    }
+}
+
+
+/**
+    Advances the time by one tick, invoking the callbacks that are due.
+ */
+void TimerWheel::advance() {
+    ++m_time;
+
+    //when a wheel completes a turn, the next slot of the wheel above it is moved down
+    for(uint32_t level = 1; level < _levels && ((m_time >> (_slotBits * (level - 1))) & (_slots - 1)) == 0; ++level) {
+        _cascade(level);
+    }
+
+    //the callbacks are moved to the due list, so as that the slot can receive new callbacks while they are invoked
+    uint32_t slot = m_time & (_slots - 1);
+    while (m_lists[slot] != _nil) {
+        uint32_t index = m_lists[slot];
+        _unlink(index);
+        _link(index, _dueList);
+    }
+
+    //invoke the callbacks; a callback may cancel the ones after it
+    while (m_lists[_dueList] != _nil) {
+        uint32_t index = m_lists[_dueList];
+        Callback callback = std::move(m_entries[index].callback);
+        _release(index);
+        callback();
+    }
+}
+
+
+//returns true if the given id is of a scheduled callback
+bool TimerWheel::_isScheduled(Id id) const {
+    uint32_t index = (uint32_t)id;
+    return index < m_entries.size() && m_entries[index].generation == (uint32_t)(id >> 32) && m_entries[index].list != _nil;
+}
+
+
+//puts an entry in the slot for its time
+void TimerWheel::_place(uint32_t index) {
+    uint64_t time = m_entries[index].time;
+    uint64_t delay = time - m_time;
+    uint32_t level = 0;
+    for(; level < _levels - 1 && delay >= ((uint64_t)1 << (_slotBits * (level + 1))); ++level);
+    _link(index, level * _slots + ((time >> (_slotBits * level)) & (_slots - 1)));
+}
+
+
+//moves the entries of a slot to the slots for their time
+void TimerWheel::_cascade(uint32_t level) {
+    uint32_t list = level * _slots + ((m_time >> (_slotBits * level)) & (_slots - 1));
+    uint32_t index = m_lists[list];
+    m_lists[list] = _nil;
+    while (index != _nil) {
+        uint32_t next = m_entries[index].next;
+        m_entries[index].list = _nil;
+        _place(index);
+        index = next;
+    }
+}
+
+
+//adds an entry to a list
+void TimerWheel::_link(uint32_t index, uint32_t list) {
+    _Entry &entry = m_entries[index];
+    entry.list = list;
+    entry.prev = _nil;
+    entry.next = m_lists[list];
+    if (entry.next != _nil) {
+        m_entries[entry.next].prev = index;
+    }
+    m_lists[list] = index;
+}
+
+
+//removes an entry from its list
+void TimerWheel::_unlink(uint32_t index) {
+    _Entry &entry = m_entries[index];
+    if (entry.prev != _nil) {
+        m_entries[entry.prev].next = entry.next;
+    }
+    else {
+        m_lists[entry.list] = entry.next;
+    }
+    if (entry.next != _nil) {
+        m_entries[entry.next].prev = entry.prev;
+    }
+    entry.list = _nil;
+}
+
+
+//removes an entry from its list and its owner, and frees it
+void TimerWheel::_release(uint32_t index) {
+    _unlink(index);
+
+    _Entry &entry = m_entries[index];
+    if (entry.ownerPrev != _nil) {
+        m_entries[entry.ownerPrev].ownerNext = entry.ownerNext;
+    }
+    else if (entry.ownerNext != _nil) {
+        m_owners[entry.owner] = entry.ownerNext;
+    }
+    else {
+        m_owners.erase(entry.owner);
+    }
+    if (entry.ownerNext != _nil) {
+        m_entries[entry.ownerNext].ownerPrev = entry.ownerPrev;
+    }
+
+    entry.owner = nullptr;
+    entry.callback = nullptr;
+    ++entry.generation;
+    entry.next = m_free;
+    m_free = index;
+    --m_size;
+}
+
+
+} //namespace amgui
@@ -0,0 +1,186 @@
+#ifndef AMGUI_TIMERWHEEL_HPP
+#define AMGUI_TIMERWHEEL_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+
+namespace amgui {
+
+
+/**
+    Schedules callbacks to be invoked after a number of ticks.
+    The callbacks are kept in a hierarchy of wheels of slots; each wheel covers 256 times the range of the one below it.
+    Scheduling and cancelling a callback takes O(1) time, and so does advancing the time by one tick, amortized;
+    callbacks in the upper wheels are moved down only when their time approaches.
+    Each callback has an owner, so as that all the callbacks of an owner can be cancelled together.
+ */
+class TimerWheel {
+public:
+    /**
+        Id of a scheduled callback; 0 is not a valid id.
+     */
+    typedef uint64_t Id;
+
+    /**
+        Type of callbacks.
+     */
+    typedef std::function<void()> Callback;
+
+    /**
+        The maximum delay of a callback, in ticks.
+     */
+    static const uint32_t maxDelay = 0x7fffffff;
+
+    /**
+        The constructor.
+     */
+    TimerWheel();
+
+    /**
+        The copy constructor is deleted.
+     */
+    TimerWheel(const TimerWheel &wheel) = delete;
+
+    /**
+        The copy assignment is deleted.
+     */
+    TimerWheel &operator = (const TimerWheel &wheel) = delete;
+
+    /**
+        Returns the number of ticks the wheel has advanced.
+     */
+    uint64_t getTime() const {
+        return m_time;
+    }
+
+    /**
+        Returns the number of scheduled callbacks.
+     */
+    size_t size() const {
+        return m_size;
+    }
+
+    /**
+        Returns true if there are no scheduled callbacks.
+     */
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    /**
+        Schedules a callback.
+        @param owner owner of the callback.
+        @param delay number of ticks after which the callback is invoked; at least 1 tick, at most maxDelay ticks.
+        @param callback callback to invoke.
+        @return id of the scheduled callback.
+     */
+    Id schedule(const void *owner, uint32_t delay, const Callback &callback);
+
+    /**
+        Cancels a scheduled callback.
+        @param id id of the callback.
+        @return true if the callback was cancelled, false if it was already invoked or cancelled.
+     */
+    bool cancel(Id id);
+
+    /**
+        Returns the owner of a scheduled callback.
+        @param id id of the callback.
+        @return the owner, or null if the callback was already invoked or cancelled.
+     */
+    const void *getOwner(Id id) const;
+
+    /**
+        Cancels all the callbacks of the given owner.
+     */
+    void cancelOwner(const void *owner);
+
+    /**
+        Cancels all the callbacks of the owners for which the given function returns true.
+     */
+    void cancelOwners(const std::function<bool(const void *)> &predicate);
+
+    /**
+        Cancels all the callbacks.
+        If it is invoked by a callback, the rest of the callbacks due in the current tick are not invoked.
+     */
+    void clear();
+
+    /**
+        Advances the time by one tick, invoking the callbacks that are due.
+        Callbacks may schedule and cancel callbacks.
+     */
+    void advance();
+
+private:
+    //wheels and slots per wheel
+    static const uint32_t _levels = 4;
+    static const uint32_t _slotBits = 8;
+    static const uint32_t _slots = 1 << _slotBits;
+
+    //list of callbacks to invoke in the current tick
+    static const uint32_t _dueList = _levels * _slots;
+
+    //null index
+    static const uint32_t _nil = 0xffffffff;
+
+    //scheduled callback; unused entries are kept in a free list
+    struct _Entry {
+        uint64_t time;
+        const void *owner;
+        Callback callback;
+        uint32_t generation;
+        uint32_t list;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t ownerPrev;
+        uint32_t ownerNext;
+    };
+
+    //current time
+    uint64_t m_time;
+
+    //number of scheduled callbacks
+    size_t m_size;
+
+    //entries
+    std::vector<_Entry> m_entries;
+
+    //first unused entry
+    uint32_t m_free;
+
+    //first entry of each slot of each wheel, plus the due list
+    uint32_t m_lists[_levels * _slots + 1];
+
+    //first entry of each owner
+    std::unordered_map<const void *, uint32_t> m_owners;
+
+    //returns true if the given id is of a scheduled callback
+    bool _isScheduled(Id id) const;
+
+    //puts an entry in the slot for its time
+    void _place(uint32_t index);
+
+    //moves the entries of a slot to the slots for their time
+    void _cascade(uint32_t level);
+
+    //adds an entry to a list
+    void _link(uint32_t index, uint32_t list);
+
+    //removes an entry from its list
+    void _unlink(uint32_t index);
+
+    //removes an entry from its list and its owner, and frees it
+    void _release(uint32_t index);
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_TIMERWHEEL_HPP
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include "TreeView.hpp"
+
+
+namespace amgui {
+
+
+/**
+    The constructor.
+ */
+TreeView::TreeView() {
+}
+
+
+/**
+    Sets the data source; the expanded state of all nodes is reset.
+    @param dataSource data source; it may be null.
+ */
+void TreeView::setDataSource(const std::shared_ptr<TreeDataSource> &dataSource) {
+    m_treeDataSource = dataSource;
+    m_root.reset();
+    if (dataSource) {
+        TreeDataSource::Node node = dataSource->getRoot();
+        size_t childCount = dataSource->getChildCount(node);
+        m_root.reset(new _Branch{node, nullptr, 0, childCount, true, childCount, {}, {0}});
+    }
+
+    //a new adapter, so as that the list view drops the row widgets of the previous data source
+    ListView::setDataSource(dataSource ? std::make_shared<_Rows>(this) : nullptr);
+}
+
+
+/**
+    Returns the node of the given row; the row must be less than the row count.
+ */
+TreeDataSource::Node TreeView::getRowNode(size_t row) const {
+    _Location location;
+    return _locate(row, location) ? _getNode(location) : TreeDataSource::Node();
+}
+
+
+/**
+    Returns the depth of the node of the given row, or npos if there is no such row.
+ */
+size_t TreeView::getRowDepth(size_t row) const {
+    _Location location;
+    return _locate(row, location) ? location.depth : npos;
+}
+
+
+/**
+    Returns true if the node of the given row is expanded.
+ */
+bool TreeView::isRowExpanded(size_t row) const {
+    _Location location;
+    return _locate(row, location) && location.branch && location.branch->expanded;
+}
+
+
+/**
+    Expands the node of the given row.
+ */
+void TreeView::expandRow(size_t row) {
+    _Location location;
+    if (!_locate(row, location)) return;
+
+    //the first time, create the branch, with the number of children from the data source
+    _Branch *branch = location.branch;
+    if (!branch) {
+        _Branch *parent = location.parent;
+        TreeDataSource::Node node = m_treeDataSource->getChild(parent->node, location.index);
+        size_t childCount = m_treeDataSource->getChildCount(node);
+        branch = new _Branch{node, parent, location.index, childCount, false, childCount, {}, {0}};
+
+        //a collapsed branch has no rows, so the offsets after it stay the same
+        size_t position = std::lower_bound(parent->branches.begin(), parent->branches.end(), location.index,
+            [](const std::unique_ptr<_Branch> &b, size_t index) { return b->index < index; }) - parent->branches.begin();
+        parent->branches.insert(parent->branches.begin() + position, std::unique_ptr<_Branch>(branch));
+        parent->offsets.insert(parent->offsets.begin() + position, parent->offsets[position]);
+    }
+
+    if (branch->expanded) return;
+    branch->expanded = true;
+    _addRows(branch, branch->rows);
+    reloadRows();
+}
+
+
+/**
+    Collapses the node of the given row.
+ */
+void TreeView::collapseRow(size_t row) {
+    _Location location;
+    if (!_locate(row, location) || !location.branch || !location.branch->expanded) return;
+    _removeRows(location.branch, location.branch->rows);
+    location.branch->expanded = false;
+    reloadRows();
+}
+
+
+/**
+    Expands the node of the given row if it is collapsed, or collapses it if it is expanded.
+ */
+void TreeView::toggleRow(size_t row) {
+    if (isRowExpanded(row)) {
+        collapseRow(row);
+    }
+    else {
+        expandRow(row);
+    }
+}
+
+
+/**
+    Returns the number of rows.
+ */
+size_t TreeView::getRowCount() const {
+    return m_root ? m_root->rows : 0;
+}
+
+
+//returns the number of rows
+size_t TreeView::_Rows::getRowCount() const {
+    return m_tree->getRowCount();
+}
+
+
+//returns the height of the rows
+float TreeView::_Rows::getRowHeight() const {
+    return m_tree->m_treeDataSource->getRowHeight();
+}
+
+
+//creates a widget for showing rows
+WidgetPtr TreeView::_Rows::createRow() {
+    return m_tree->m_treeDataSource->createRow();
+}
+
+
+//binds a widget to the node of a row
+void TreeView::_Rows::bindRow(size_t row, const WidgetPtr &widget) {
+    _Location location;
+    if (!m_tree->_locate(row, location)) return;
+    bool expanded = location.branch && location.branch->expanded;
+    m_tree->m_treeDataSource->bindRow(row, m_tree->_getNode(location), location.depth, expanded, widget);
+}
+
+
+//finds the row; returns false if there is no such row
+bool TreeView::_locate(size_t row, _Location &location) const {
+    _Branch *branch = m_root.get();
+    if (!branch || row >= branch->rows) return false;
+
+    for(size_t depth = 0; ; ++depth) {
+        //find the last branch which starts at or before the row
+        const std::vector<std::unique_ptr<_Branch>> &branches = branch->branches;
+        size_t low = 0, high = branches.size();
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (branches[middle]->index + branch->offsets[middle] <= row) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+
+        //the row is a child before the first branch
+        if (low == 0) {
+            location = _Location{branch, row, depth, nullptr};
+            return true;
+        }
+
+        //the row is the node of the branch
+        _Branch *sub = branches[low - 1].get();
+        size_t start = sub->index + branch->offsets[low - 1];
+        if (row == start) {
+            location = _Location{branch, sub->index, depth, sub};
+            return true;
+        }
+
+        //the row is below the node of the branch
+        if (sub->expanded && row - start - 1 < sub->rows) {
+            row -= start + 1;
+            branch = sub;
+            continue;
+        }
+
+        //the row is a child after the branch
+        location = _Location{branch, row - branch->offsets[low], depth, nullptr};
+        return true;
+    }
+}
+
+
+//returns the node of a location
+TreeDataSource::Node TreeView::_getNode(const _Location &location) const {
+    return location.branch ? location.branch->node : m_treeDataSource->getChild(location.parent->node, location.index);
+}
+
+
+//adds rows below a branch, updating the counts of its ancestors
+void TreeView::_addRows(_Branch *branch, size_t rows) {
+    //the rows of a collapsed branch do not count in its parent
+    for(; branch->parent && branch->expanded; branch = branch->parent) {
+        _Branch *parent = branch->parent;
+        for(size_t i = _getPosition(branch) + 1; i < parent->offsets.size(); ++i) {
+            parent->offsets[i] += rows;
+        }
+        parent->rows += rows;
+    }
+}
+
+
+//removes rows below a branch, updating the counts of its ancestors
+void TreeView::_removeRows(_Branch *branch, size_t rows) {
+    for(; branch->parent && branch->expanded; branch = branch->parent) {
+        _Branch *parent = branch->parent;
+        for(size_t i = _getPosition(branch) + 1; i < parent->offsets.size(); ++i) {
+            parent->offsets[i] -= rows;
+        }
+        parent->rows -= rows;
+    }
+}
+
+
+//returns the position of a branch among the branches of its parent
+size_t TreeView::_getPosition(const _Branch *branch) {
+    const std::vector<std::unique_ptr<_Branch>> &branches = branch->parent->branches;
+    return std::lower_bound(branches.begin(), branches.end(), branch->index,
+        [](const std::unique_ptr<_Branch> &b, size_t index) { return b->index < index; }) - branches.begin();
+}
+
+
+} //namespace amgui
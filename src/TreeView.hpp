@@ -0,0 +1,200 @@
+#ifndef AMGUI_TREEVIEW_HPP
+#define AMGUI_TREEVIEW_HPP
+
+
+#include <cstdint>
+#include "ListView.hpp"
+
+
+namespace amgui {
+
+
+/**
+    Interface of the data shown by a tree view.
+    Nodes are identified by values the data source chooses, such as indexes or pointers.
+    The tree view asks for the children of a node only when the node is expanded,
+    and for a child only when its row is shown.
+ */
+class TreeDataSource {
+public:
+    /**
+        Node identifier.
+     */
+    typedef uint64_t Node;
+
+    /**
+        The destructor.
+     */
+    virtual ~TreeDataSource() {
+    }
+
+    /**
+        Returns the root node; the root itself is not shown, its children are the top-level rows.
+     */
+    virtual Node getRoot() = 0;
+
+    /**
+        Returns the number of children of a node.
+     */
+    virtual size_t getChildCount(Node node) = 0;
+
+    /**
+        Returns a child of a node.
+        @param node parent node.
+        @param index index of the child.
+     */
+    virtual Node getChild(Node node, size_t index) = 0;
+
+    /**
+        Returns the height of the rows; all rows have the same height.
+     */
+    virtual float getRowHeight() const = 0;
+
+    /**
+        Creates a widget for showing rows.
+     */
+    virtual WidgetPtr createRow() = 0;
+
+    /**
+        Sets up a widget created by createRow() to show the given node.
+        @param row index of the row; it changes as rows above it are expanded or collapsed.
+        @param node node of the row.
+        @param depth depth of the node; 0 for the children of the root.
+        @param expanded true if the node is expanded.
+        @param widget widget to set up.
+     */
+    virtual void bindRow(size_t row, Node node, size_t depth, bool expanded, const WidgetPtr &widget) = 0;
+};
+
+
+/**
+    Tree of rows that creates widgets only for the rows it shows.
+    The tree keeps state only for the nodes that have been expanded;
+    along with each of them it keeps the number of rows below it,
+    so finding the node of a row takes time proportional to the depth of the node,
+    and expanding or collapsing a node takes time proportional to its depth and the number of expanded siblings,
+    regardless of the number of its descendants.
+    Collapsed nodes remember which of their descendants were expanded.
+ */
+class TreeView : public ListView {
+public:
+    /**
+        The constructor.
+     */
+    TreeView();
+
+    /**
+        Returns the data source.
+     */
+    const std::shared_ptr<TreeDataSource> &getDataSource() const {
+        return m_treeDataSource;
+    }
+
+    /**
+        Sets the data source; the expanded state of all nodes is reset.
+        @param dataSource data source; it may be null.
+     */
+    void setDataSource(const std::shared_ptr<TreeDataSource> &dataSource);
+
+    /**
+        Returns the node of the given row; the row must be less than the row count.
+     */
+    TreeDataSource::Node getRowNode(size_t row) const;
+
+    /**
+        Returns the depth of the node of the given row, or npos if there is no such row.
+     */
+    size_t getRowDepth(size_t row) const;
+
+    /**
+        Returns true if the node of the given row is expanded.
+     */
+    bool isRowExpanded(size_t row) const;
+
+    /**
+        Expands the node of the given row; its children are requested from the data source the first time.
+     */
+    void expandRow(size_t row);
+
+    /**
+        Collapses the node of the given row.
+     */
+    void collapseRow(size_t row);
+
+    /**
+        Expands the node of the given row if it is collapsed, or collapses it if it is expanded.
+     */
+    void toggleRow(size_t row);
+
+    /**
+        Returns the number of rows.
+     */
+    size_t getRowCount() const;
+
+private:
+    //a node that has been expanded
+    struct _Branch {
+        TreeDataSource::Node node;
+        _Branch *parent;
+        size_t index;
+        size_t childCount;
+        bool expanded;
+
+        //rows below the node, when it is expanded
+        size_t rows;
+
+        //branches of the children, by index, and the rows below the branches before each of them
+        std::vector<std::unique_ptr<_Branch>> branches;
+        std::vector<size_t> offsets;
+    };
+
+    //location of a row
+    struct _Location {
+        _Branch *parent;
+        size_t index;
+        size_t depth;
+        _Branch *branch;
+    };
+
+    //adapts the tree to the list data source interface
+    class _Rows : public ListDataSource {
+    public:
+        _Rows(TreeView *tree) : m_tree(tree) {
+        }
+
+        virtual size_t getRowCount() const override;
+        virtual float getRowHeight() const override;
+        virtual WidgetPtr createRow() override;
+        virtual void bindRow(size_t row, const WidgetPtr &widget) override;
+
+    private:
+        TreeView *m_tree;
+    };
+
+    //data source
+    std::shared_ptr<TreeDataSource> m_treeDataSource;
+
+    //the branch of the root
+    std::unique_ptr<_Branch> m_root;
+
+    //finds the row; returns false if there is no such row
+    bool _locate(size_t row, _Location &location) const;
+
+    //returns the node of a location
+    TreeDataSource::Node _getNode(const _Location &location) const;
+
+    //adds rows below a branch, updating the counts of its ancestors
+    void _addRows(_Branch *branch, size_t rows);
+
+    //removes rows below a branch, updating the counts of its ancestors
+    void _removeRows(_Branch *branch, size_t rows);
+
+    //returns the position of a branch among the branches of its parent
+    static size_t _getPosition(const _Branch *branch);
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_TREEVIEW_HPP
@@ -1,3 +1,4 @@
+#include <cmath>
 #include <algorithm>
 #include "Widget.hpp"
 
@@ -5,44 +6,124 @@
 namespace amgui {
 
 
+//maximum number of damaged areas kept separately before they are merged into one
+static const size_t _maxDamageRects = 8;
+
+
+//minimum number of grandchildren the children that need layout must have for laying them out in parallel
+static const size_t _minParallelLayoutWidgets = 64;
+
+
+//returns the clipping rectangle of the target bitmap
+static Rect _getClippingRectangle() {
+    int x, y, w, h;
+    al_get_clipping_rectangle(&x, &y, &w, &h);
+    return Rect(x, y, x + w - 1, y + h - 1);
+}
+
+
+//sets the clipping rectangle of the target bitmap to the pixels the given rectangle touches
+static void _setClippingRectangle(const Rect &rect) {
+    int left = (int)std::floor(rect.getLeft());
+    int top = (int)std::floor(rect.getTop());
+    int right = (int)std::ceil(rect.getRight());
+    int bottom = (int)std::ceil(rect.getBottom());
+    al_set_clipping_rectangle(left, top, right - left + 1, bottom - top + 1);
+}
+
+
+//returns true if the current transformation is the identity
+static bool _isIdentityTransform() {
+    const ALLEGRO_TRANSFORM *transform = al_get_current_transform();
+    if (!transform) return true;
+    for(int i = 0; i < 4; ++i) {
+        for(int j = 0; j < 4; ++j) {
+            if (transform->m[i][j] != (i == j ? 1 : 0)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+//a clip rectangle that contains everything
+static const Rect _noClip(-1e9f, -1e9f, 1e9f, 1e9f);
+
+
+//modifiers which are part of shortcuts; the rest, such as the lock keys, are ignored
+static const int _shortcutModifiers = ALLEGRO_KEYMOD_SHIFT | ALLEGRO_KEYMOD_CTRL | ALLEGRO_KEYMOD_ALT | ALLEGRO_KEYMOD_LWIN | ALLEGRO_KEYMOD_RWIN | ALLEGRO_KEYMOD_MENU | ALLEGRO_KEYMOD_ALTGR | ALLEGRO_KEYMOD_COMMAND;
+
+
+//returns the key of a shortcut
+static uint64_t _getShortcutKey(int keycode, int modifiers) {
+    return ((uint64_t)(uint32_t)keycode << 32) | (uint32_t)(modifiers & _shortcutModifiers);
+}
+
+
 /**
     The default constructor.
  */
 Widget::Widget() :
+    m_parent(nullptr),
+    m_slot(0),
+    m_mouseChild(nullptr),
+    m_mouseChildCount(0),
+    m_mouseChildVersion(WidgetList::npos),
+    m_cacheBitmap(nullptr),
     m_visible(true),
     m_enabled(true),
     m_mouse(false),
     m_pushed(false),
-    m_selected(false)
+    m_selected(false),
+    m_cached(false),
+    m_cacheValid(false),
+    m_cacheEnabled(false),
+    m_cacheHighlighted(false),
+    m_cachePushed(false),
+    m_cacheSelected(false),
+    m_clipChildren(false),
+    m_boundsValid(false),
+    m_timerSubscribed(false),
+    m_measuredWidth(0),
+    m_measuredHeight(0),
+    m_inPack(false),
+    m_needsPack(true),
+    m_needsLayout(true),
+    m_descendantNeedsLayout(false),
+    m_inLayout(false),
+    m_hasShortcuts(false),
+    m_unusedKeyTarget(false),
+    m_descendantUnusedKeyTarget(false),
+    m_serialLayout(false),
+    m_descendantSerialLayout(false),
+    m_mouseChildOverlapped(false),
+    m_hitAreaExtended(false)
 {
 }
 
 
 /**
-    Returns the previous sibling.
+    Removes this widget from its parent.
+    The children that outlive this widget are left without a parent.
  */
-WidgetPtr Widget::getPrevSibling() const {
-    WidgetPtr parent = m_parent.lock();
-    if (parent && m_it != parent->m_children.begin()) {
-        auto it = m_it;
-        --it;
-        return *it;
+Widget::~Widget() {
+    removeFromParent();
+
+    //the timer subscribers of a child that outlives this belong to the child's tree from now on
+    for(Widget *subscriber : m_timerSubscribers) {
+        if (subscriber != this) {
+            Widget *child = subscriber;
+            for(; child->m_parent != this; child = child->m_parent);
+            child->m_timerSubscribers.push_back(subscriber);
+        }
     }
-    return WidgetPtr();
-}
-
 
-/**
-    Returns the next sibling.
- */
-WidgetPtr Widget::getNextSibling() const {
-    WidgetPtr parent = m_parent.lock();
-    if (parent) {
-        auto it = m_it;
-        ++it;
-        return it != parent->m_children.end() ? *it : WidgetPtr();
+    for(const WidgetPtr &child : m_children) {
+        child->m_parent = nullptr;
     }
-    return WidgetPtr();
+    removeAllShortcuts();
+    _destroyCache();
 }
 
 
@@ -50,18 +131,18 @@ WidgetPtr Widget::getNextSibling() const {
     Returns the root widget of this widget tree.
  */
 WidgetPtr Widget::getRoot() const {
-    WidgetPtr result;
-    for(WidgetPtr ptr = std::const_pointer_cast<Widget>(shared_from_this()); ptr; result = ptr, ptr = ptr->getParent());
-    return result;
+    const Widget *root = this;
+    for(; root->m_parent; root = root->m_parent);
+    return std::const_pointer_cast<Widget>(root->shared_from_this());
 }
 
 
 /**
     Returns true if this widget tree contains the given widget.
  */
-bool Widget::contains(const WidgetPtr &wgt) const {
-    for(WidgetPtr temp = wgt; temp; temp = temp->getParent()) {
-        if (temp.get() == this) {
+bool Widget::contains(const Widget *wgt) const {
+    for(; wgt; wgt = wgt->m_parent) {
+        if (wgt == this) {
             return true;
         }
     }
@@ -86,14 +167,73 @@ bool Widget::addChild(const WidgetPtr &widget, const WidgetPtr &childAfter/* = n
     if (widget == childAfter) return false;
 
     //can't have a parent
-    if (widget->m_parent.lock()) return false;
+    if (widget->m_parent) return false;
 
     //if the childAfter is specified, then its parent must be this
-    if (childAfter && childAfter->m_parent.lock().get() != this) return false;
+    if (childAfter && childAfter->m_parent != this) return false;
 
     //insert the child
-    widget->m_parent = shared_from_this();
-    widget->m_it = m_children.insert(childAfter ? childAfter->m_it : m_children.end(), widget);
+    widget->m_parent = this;
+    if (childAfter) {
+        m_children.insert(childAfter->m_slot, widget);
+    }
+    else {
+        m_children.push_back(widget);
+    }
+
+    //index the child
+    if (m_spatialIndex) {
+        m_spatialIndex->insert(widget.get(), widget->_getHitRect());
+    }
+    if (widget->m_mouse) {
+        _updateMouseChild(widget.get(), true);
+    }
+
+    //the callbacks scheduled in the tree of the child are cancelled, since its root no longer dispatches timer events;
+    //a callback of the wheel may be adding the child, so the wheel is cleared, and the rest of the due callbacks are not invoked
+    if (widget->m_timerWheel) {
+        widget->m_timerWheel->clear();
+        widget->m_timerWheel.reset();
+    }
+
+    //unused key events must reach the child's targets, and the child's tree may need to be laid out serially
+    if (widget->_containsUnusedKeyTarget()) {
+        widget->_markUnusedKeyTargetAncestors();
+    }
+    if (widget->m_serialLayout || widget->m_descendantSerialLayout) {
+        widget->_markSerialLayoutAncestors();
+    }
+
+    //the timer subscribers of the child now belong to the tree of this;
+    //when laid out in parallel, they are added to the root afterwards
+    if (!widget->m_timerSubscribers.empty()) {
+        _LayoutTask *task = _getLayoutTask();
+        if (task) {
+            for(Widget *subscriber : widget->m_timerSubscribers) {
+                task->timerChanges.push_back(_TimerChange{_TimerChange::Subscribe, subscriber, nullptr});
+            }
+        }
+        else {
+            std::vector<Widget *> &subscribers = _getRootWidget()->m_timerSubscribers;
+            subscribers.insert(subscribers.end(), widget->m_timerSubscribers.begin(), widget->m_timerSubscribers.end());
+        }
+        widget->m_timerSubscribers.clear();
+    }
+
+    //the child is no longer a root, so its damage is redrawn through this tree
+    widget->m_damage.clear();
+    widget->invalidate();
+    _invalidateBounds();
+
+    //the child must be laid out, and the layout pass must reach the parts of its tree that need it;
+    //if this adds the child while laying out, it lays out the child too
+    invalidatePack();
+    if (!m_inLayout) {
+        invalidateLayout();
+    }
+    if (widget->m_needsLayout || widget->m_descendantNeedsLayout) {
+        widget->_invalidateAncestorsLayout();
+    }
 
     //success
     return true;
@@ -108,11 +248,36 @@ bool Widget::removeChild(const WidgetPtr &widget) {
     if (!widget) return false;
 
     //must be child
-    if (widget->m_parent.lock().get() != this) return false;
+    if (widget->m_parent != this) return false;
+
+    //redraw the area the child occupied
+    widget->invalidate();
 
     //remove the child
-    m_children.erase(widget->m_it);
-    widget->m_parent.reset();
+    if (m_spatialIndex) {
+        m_spatialIndex->remove(widget.get(), widget->_getHitRect());
+    }
+    if (widget->m_mouse) {
+        _updateMouseChild(widget.get(), false);
+    }
+    m_children.erase(widget->m_slot);
+
+    //the callbacks scheduled by the child's tree are cancelled, and its timer subscribers move to the child, which becomes a root;
+    //when laid out in parallel, that is done afterwards, since it visits the whole tree
+    _LayoutTask *task = _getLayoutTask();
+    if (task) {
+        task->timerChanges.push_back(_TimerChange{_TimerChange::RemoveChild, nullptr, widget});
+    }
+    else {
+        _removeTimerState(widget.get(), true);
+    }
+
+    widget->m_parent = nullptr;
+    _invalidateBounds();
+    invalidatePack();
+    if (!m_inLayout) {
+        invalidateLayout();
+    }
 
     //if the child has the mouse, do a mouseLeave on the child,
     //because since it is removed it can no longer have the mouse
@@ -129,9 +294,8 @@ bool Widget::removeChild(const WidgetPtr &widget) {
     Removes this widget from its parent.
  */
 void Widget::removeFromParent() {
-    WidgetPtr parent = m_parent.lock();
-    if (parent) {
-        parent->removeChild(shared_from_this());
+    if (m_parent) {
+        m_parent->removeChild(shared_from_this());
     }
 }
 
@@ -140,7 +304,79 @@ void Widget::removeFromParent() {
     Sets the rectangle of the widget.
  */
 void Widget::setRect(float x, float y, float width, float height) {
-    m_rect.setPositionAndSize(x, y, std::max(width, 0.f), std::max(height, 0.f));
+    Rect rect;
+    rect.setPositionAndSize(x, y, std::max(width, 0.f), std::max(height, 0.f));
+
+    //unless the parent is laying out this, the size is the size this needs
+    if (!m_parent || !m_parent->m_inLayout) {
+        setMeasuredSize(rect.getWidth(), rect.getHeight());
+    }
+
+    //nothing to do if the rectangle does not change
+    if (rect == m_rect) return;
+
+    //moving the widget does not change its contents, so the cache stays valid
+    bool sameSize = rect.getWidth() == m_rect.getWidth() && rect.getHeight() == m_rect.getHeight();
+    bool cacheValid = m_cacheValid && sameSize;
+
+    //redraw the area the widget occupied
+    invalidate();
+
+    //the parent's index must be updated with the new rectangle
+    if (m_parent && m_parent->m_spatialIndex) {
+        m_parent->m_spatialIndex->remove(this, _getHitRect());
+        m_rect = rect;
+        m_parent->m_spatialIndex->insert(this, _getHitRect());
+    }
+    else {
+        m_rect = rect;
+    }
+    if (m_parent) {
+        m_parent->m_children.update(m_slot);
+    }
+
+    //redraw the area the widget now occupies
+    invalidate();
+    m_cacheValid = cacheValid;
+
+    //a new size changes the bounds of this, a new position changes the bounds of the parent;
+    //a new size also requires laying out the children again
+    if (sameSize) {
+        _invalidateParentBounds();
+    }
+    else {
+        _invalidateBounds();
+        invalidateLayout();
+    }
+}
+
+
+/**
+    Sets the visible flag.
+ */
+void Widget::setVisible(bool visible) {
+    if (visible == m_visible) return;
+
+    //invalidate while visible, since invisible widgets record no damage
+    if (visible) {
+        m_visible = true;
+        invalidate();
+    }
+    else {
+        invalidate();
+        m_visible = false;
+    }
+    if (m_parent) {
+        m_parent->m_children.update(m_slot);
+    }
+
+    //invisible children are not part of the bounds of the parent, nor of its layout,
+    //unless the parent shows or hides this while laying out
+    _invalidateParentBounds();
+    if (m_parent && !m_parent->m_inLayout) {
+        m_parent->invalidatePack();
+        m_parent->invalidateLayout();
+    }
 }
 
 
@@ -148,8 +384,8 @@ void Widget::setRect(float x, float y, float width, float height) {
     Returns true of all widgets from this to root are enabled.
  */
 bool Widget::isEnabledTree() const {
-    for(WidgetPtr ptr = std::const_pointer_cast<Widget>(shared_from_this()); ptr; ptr = ptr->getParent()) {
-        if (!ptr->m_enabled) {
+    for(const Widget *wgt = this; wgt; wgt = wgt->m_parent) {
+        if (!wgt->m_enabled) {
             return false;
         }
     }
@@ -163,6 +399,7 @@ bool Widget::isEnabledTree() const {
 void Widget::setEnabled(bool enabled) {
     if (enabled == m_enabled) return;
     m_enabled = enabled;
+    invalidate();
 
     //special actions if the widget is disabled
     if (!enabled) {
@@ -183,15 +420,173 @@ void Widget::setEnabled(bool enabled) {
 }
 
 
+/**
+    Sets the widget to the pushed state.
+ */
+void Widget::setPushed(bool pushed) {
+    if (pushed == m_pushed) return;
+    m_pushed = pushed;
+    invalidate();
+}
+
+
+/**
+    Sets the widget to the selected state.
+ */
+void Widget::setSelected(bool selected) {
+    if (selected == m_selected) return;
+    m_selected = selected;
+    invalidate();
+}
+
+
+/**
+    Marks an area of the widget as needing to be redrawn.
+    @param rect rectangle to redraw, relative to the widget.
+ */
+void Widget::invalidateRect(const Rect &rect) {
+    if (rect.isEmpty()) return;
+
+    //convert the rectangle to the coordinates of the root;
+    //the caches of the widgets on the way contain the area, so they must be redrawn too
+    Rect area = rect;
+    Widget *root = this;
+    for(Widget *wgt = this; wgt; wgt = wgt->m_parent) {
+        wgt->m_cacheValid = false;
+        if (!wgt->m_visible) return;
+        area.translate(wgt->getX(), wgt->getY());
+        root = wgt;
+
+        //when laid out in parallel, the area is damaged outside of the subtree afterwards
+        if (_layoutTask && wgt == _layoutTask->root) {
+            _layoutTask->damage.push_back(area);
+            return;
+        }
+    }
+
+    root->_addDamage(area);
+}
+
+
+/**
+    Draws this widget at the current X and Y of the widget, using the widget properties as parameters.
+    Children that are entirely outside of the target bitmap's clipping rectangle are not drawn.
+    The current primitive batch is flushed afterwards.
+ */
+void Widget::draw() {
+    //culling is done in the coordinates of the target bitmap, so it is not possible under a transformation
+    Rect clip = _drawClip;
+    _drawClip = _isIdentityTransform() ? _getClippingRectangle() : _noClip;
+    _draw(0, 0, true, m_mouse, m_pushed, m_selected);
+    PrimitiveBatch::getCurrent()->flush();
+    _drawClip = clip;
+}
+
+
+/**
+    Returns the area occupied by this widget and its visible descendants, relative to this widget.
+ */
+const Rect &Widget::getSubtreeBounds() const {
+    if (!m_boundsValid) {
+        m_bounds = Rect(0, 0, getWidth() - 1, getHeight() - 1);
+        if (!m_clipChildren) {
+            for(const WidgetPtr &child : m_children) {
+                if (child->m_visible) {
+                    Rect bounds = child->getSubtreeBounds();
+                    bounds.translate(child->getX(), child->getY());
+                    m_bounds = m_bounds.getUnion(bounds);
+                }
+            }
+        }
+        m_boundsValid = true;
+    }
+    return m_bounds;
+}
+
+
+/**
+    Sets the clip children flag.
+ */
+void Widget::setClipChildren(bool clip) {
+    if (clip == m_clipChildren) return;
+    m_clipChildren = clip;
+    invalidate();
+    _invalidateBounds();
+}
+
+
+/**
+    Redraws the areas that need to be redrawn, using clipping, then clears the list of damaged areas.
+    @return true if something was drawn, false if there was no damage.
+ */
+bool Widget::redraw() {
+    if (m_damage.empty()) return false;
+
+    //the damage is drawn within the current clipping rectangle
+    Rect clip = _getClippingRectangle();
+
+    //draw the tree once for each damaged area
+    for(const Rect &rect : m_damage) {
+        Rect area = rect.getIntersection(clip);
+        if (area.isEmpty()) continue;
+        _setClippingRectangle(area);
+        draw();
+    }
+
+    _setClippingRectangle(clip);
+    m_damage.clear();
+    return true;
+}
+
+
+/**
+    Sets the cached flag.
+ */
+void Widget::setCached(bool cached) {
+    if (cached == m_cached) return;
+    m_cached = cached;
+    if (!cached) {
+        _destroyCache();
+    }
+}
+
+
 /**
     The default implementation draws the children.
  */
 void Widget::draw(float x, float y, bool enabled, bool highlighted, bool pushed, bool selected) {
+    Rect clip = _drawClip;
+    Rect targetClip;
+
+    //clip the children to the rectangle of this
+    if (m_clipChildren) {
+        _drawClip = clip.getIntersection(Rect(x + getX(), y + getY(), x + getX() + getWidth() - 1, y + getY() + getHeight() - 1));
+        if (_drawClip.isEmpty()) {
+            _drawClip = clip;
+            return;
+        }
+        PrimitiveBatch::getCurrent()->flush();
+        targetClip = _getClippingRectangle();
+        _setClippingRectangle(_drawClip);
+    }
+
+    //draw the children which intersect the clip rectangle
     for(auto &child : m_children) {
         if (child->m_visible) {
-            child->draw(x + getX(), y + getY(), enabled && child->m_enabled, highlighted || child->m_mouse, pushed || child->m_pushed, selected || child->m_selected);
+            Rect bounds = child->getSubtreeBounds();
+            bounds.translate(x + getX() + child->getX(), y + getY() + child->getY());
+            if (bounds.intersects(_drawClip)) {
+                child->_draw(x + getX(), y + getY(), enabled && child->m_enabled, highlighted || child->m_mouse, pushed || child->m_pushed, selected || child->m_selected);
+            }
         }
     }
+
+    //restore the clipping
+    if (m_clipChildren) {
+        PrimitiveBatch::getCurrent()->flush();
+        _setClippingRectangle(targetClip);
+        _drawClip = clip;
+    }
 }
 
 
@@ -200,6 +595,11 @@ void Widget::draw(float x, float y, bool enabled, bool highlighted, bool pushed,
     @return true if the event was used by a widget, false otherwise.
  */
 bool Widget::dispatch(ALLEGRO_EVENT *event) {
+    //the posted functions are invoked even if the widget is disabled, since they are not input
+    if (event->type == PostQueue::eventType && m_postQueue && event->user.data1 == (intptr_t)m_postQueue.get()) {
+        return m_postQueue->invoke() > 0;
+    }
+
     if (!m_enabled) return false;
 
     bool result = false;
@@ -282,6 +682,8 @@ bool Widget::dispatch(ALLEGRO_EVENT *event) {
 
             //mouse wheel
             if (event->mouse.dz || event->mouse.dw) {
+                _mouseWheelDeltaZ = event->mouse.dz;
+                _mouseWheelDeltaW = event->mouse.dw;
                 if (!_dragAndDrop) {
                     result = mouseWheel(event->mouse.z, event->mouse.w) || result;
                 }
@@ -299,6 +701,8 @@ bool Widget::dispatch(ALLEGRO_EVENT *event) {
                     result = focusWidget->keyDown(event->keyboard.keycode);
                 }
                 if (!result) {
+                    //if the tree has unused key targets, the event reaches only them
+                    _unusedKeyTargetsOnly = _containsUnusedKeyTarget();
                     result = unusedKeyDown(event->keyboard.keycode);
                 }
             }
@@ -311,6 +715,8 @@ bool Widget::dispatch(ALLEGRO_EVENT *event) {
                     result = focusWidget->keyUp(event->keyboard.keycode);
                 }
                 if (!result) {
+                    //if the tree has unused key targets, the event reaches only them
+                    _unusedKeyTargetsOnly = _containsUnusedKeyTarget();
                     result = unusedKeyUp(event->keyboard.keycode);
                 }
             }
@@ -323,6 +729,11 @@ bool Widget::dispatch(ALLEGRO_EVENT *event) {
                     result = focusWidget->keyChar(event->keyboard.keycode, event->keyboard.unichar, event->keyboard.modifiers);
                 }
                 if (!result) {
+                    result = _dispatchShortcut(event->keyboard.keycode, event->keyboard.modifiers);
+                }
+                if (!result) {
+                    //if the tree has unused key targets, the event reaches only them
+                    _unusedKeyTargetsOnly = _containsUnusedKeyTarget();
                     result = unusedKeyChar(event->keyboard.keycode, event->keyboard.unichar, event->keyboard.modifiers);
                 }
             }
@@ -334,7 +745,12 @@ bool Widget::dispatch(ALLEGRO_EVENT *event) {
             break;
 
         case ALLEGRO_EVENT_TIMER:
-            result = timerTick(event->timer.timestamp, event->timer.count);
+            //a callback may add this to another widget, which releases the wheel, so the wheel is kept alive until it returns
+            if (!m_parent && m_timerWheel) {
+                std::shared_ptr<TimerWheel> timerWheel = m_timerWheel;
+                timerWheel->advance();
+            }
+            result = _timerTick(event->timer.timestamp, event->timer.count);
             break;
     }
 
@@ -342,6 +758,63 @@ bool Widget::dispatch(ALLEGRO_EVENT *event) {
 }
 
 
+/**
+    Dispatches all the events that are currently in the given queue.
+    Consecutive mouse motion events from the same source are merged into one event.
+    @param queue queue to take the events from; it is not waited on.
+    @param filter optional function invoked for each event before it is dispatched;
+        if it returns true, then the event is not dispatched to the widgets.
+    @return the number of events merged into other events.
+ */
+size_t Widget::dispatchQueue(ALLEGRO_EVENT_QUEUE *queue, const std::function<bool(ALLEGRO_EVENT &)> &filter/* = nullptr*/) {
+    size_t merged = 0;
+
+    ALLEGRO_EVENT event;
+    if (!al_get_next_event(queue, &event)) return 0;
+
+    for(;;) {
+        ALLEGRO_EVENT next;
+        bool hasNext = al_get_next_event(queue, &next);
+
+        //merge the event into the next one, if both are mouse motion events of the same mouse
+        if (hasNext &&
+            event.type == ALLEGRO_EVENT_MOUSE_AXES &&
+            next.type == ALLEGRO_EVENT_MOUSE_AXES &&
+            next.mouse.source == event.mouse.source &&
+            next.mouse.display == event.mouse.display)
+        {
+            next.mouse.dx += event.mouse.dx;
+            next.mouse.dy += event.mouse.dy;
+            next.mouse.dz += event.mouse.dz;
+            next.mouse.dw += event.mouse.dw;
+            event = next;
+            ++merged;
+            continue;
+        }
+
+        if (!filter || !filter(event)) {
+            dispatch(&event);
+        }
+
+        if (!hasNext) break;
+        event = next;
+    }
+
+    return merged;
+}
+
+
+/**
+    Returns the post queue of this widget, creating it if it does not exist.
+ */
+const std::shared_ptr<PostQueue> &Widget::getPostQueue() {
+    if (!m_postQueue) {
+        m_postQueue = std::make_shared<PostQueue>();
+    }
+    return m_postQueue;
+}
+
+
 /**
     Sets the focus to this widget.
     @return true if the focus was successfully set, false otherwise.
@@ -371,6 +844,71 @@ bool Widget::setFocus() {
 }
 
 
+/**
+    Adds a keyboard shortcut to this widget.
+    @param keycode allegro key code.
+    @param modifiers modifiers which must be pressed, such as ALLEGRO_KEYMOD_CTRL; lock keys are ignored.
+    @param handler function to invoke; it returns true if the key was processed.
+ */
+void Widget::addShortcut(int keycode, int modifiers, const std::function<bool()> &handler) {
+    MutexLock lock(_getLayoutStateMutex());
+    _shortcuts[_getShortcutKey(keycode, modifiers)].push_back(_Shortcut{this, handler});
+    m_hasShortcuts = true;
+}
+
+
+/**
+    Removes the shortcuts of this widget with the given key and modifiers.
+ */
+void Widget::removeShortcut(int keycode, int modifiers) {
+    MutexLock lock(_getLayoutStateMutex());
+    auto it = _shortcuts.find(_getShortcutKey(keycode, modifiers));
+    if (it == _shortcuts.end()) return;
+    std::vector<_Shortcut> &shortcuts = it->second;
+    shortcuts.erase(std::remove_if(shortcuts.begin(), shortcuts.end(), [&](const _Shortcut &shortcut) { return shortcut.widget == this; }), shortcuts.end());
+    if (shortcuts.empty()) {
+        _shortcuts.erase(it);
+    }
+}
+
+
+/**
+    Removes all the shortcuts of this widget.
+ */
+void Widget::removeAllShortcuts() {
+    if (!m_hasShortcuts) return;
+    MutexLock lock(_getLayoutStateMutex());
+    for(auto it = _shortcuts.begin(); it != _shortcuts.end(); ) {
+        std::vector<_Shortcut> &shortcuts = it->second;
+        shortcuts.erase(std::remove_if(shortcuts.begin(), shortcuts.end(), [&](const _Shortcut &shortcut) { return shortcut.widget == this; }), shortcuts.end());
+        it = shortcuts.empty() ? _shortcuts.erase(it) : std::next(it);
+    }
+    m_hasShortcuts = false;
+}
+
+
+/**
+    Sets the serial layout flag.
+ */
+void Widget::setSerialLayout(bool serial) {
+    m_serialLayout = serial;
+    if (serial) {
+        _markSerialLayoutAncestors();
+    }
+}
+
+
+/**
+    Sets the unused key target flag.
+ */
+void Widget::setUnusedKeyTarget(bool target) {
+    m_unusedKeyTarget = target;
+    if (target) {
+        _markUnusedKeyTargetAncestors();
+    }
+}
+
+
 /**
     Begins drag-n-drop.
     @return true if the drag-n-drop starts successfully, false otherwise.
@@ -399,14 +937,80 @@ void Widget::endDragAndDrop() {
 /**
     Returns the child with the given coordinates.
  */
-WidgetPtr Widget::childFromPoint(float x, float y) const {
-    for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-        auto &child = *it;
-        if (child->m_visible && child->intersects(x - child->getX(), y - child->getY())) {
+Widget *Widget::childFromPoint(float x, float y) const {
+    //use the index, if there is one
+    if (m_spatialIndex) {
+        Widget *result = nullptr;
+
+        //check the candidates, keeping the one with the highest z-order
+        auto test = [&](const SpatialIndex::Cell &cell) {
+            for(Widget *child : cell) {
+                if (child->m_visible &&
+                    (!result || child->m_slot > result->m_slot) &&
+                    (child->m_hitAreaExtended || (x >= child->getX() && x < child->getX() + child->getWidth() && y >= child->getY() && y < child->getY() + child->getHeight())) &&
+                    child->intersects(x - child->getX(), y - child->getY()))
+                {
+                    result = child;
+                }
+            }
+        };
+
+        const SpatialIndex::Cell *cell = m_spatialIndex->find(x, y);
+        if (cell) test(*cell);
+        test(m_spatialIndex->getLarge());
+
+        return result;
+    }
+
+    //find the children whose rectangle contains the point, or whose hit area is extended, from the top down, and ask them for the exact test
+    for(size_t slot = m_children.hitTest(x, y); slot != WidgetList::npos; slot = m_children.hitTest(x, y, slot)) {
+        Widget *child = m_children[slot].get();
+        if (child->intersects(x - child->getX(), y - child->getY())) {
             return child;
         }
     }
-    return WidgetPtr();
+    return nullptr;
+}
+
+
+/**
+    Enables or disables the spatial index of children.
+    @param enabled true to enable the index, false to disable it.
+    @param cellSize size of the cells of the index, in pixels.
+ */
+void Widget::setSpatialIndex(bool enabled, float cellSize/* = 64*/) {
+    if (!enabled) {
+        m_spatialIndex.reset();
+        return;
+    }
+
+    //create a new index and put all the children in it
+    m_spatialIndex.reset(new SpatialIndex(cellSize));
+    for(const WidgetPtr &child : m_children) {
+        m_spatialIndex->insert(child.get(), child->_getHitRect());
+    }
+}
+
+
+/**
+    Sets the extended hit area flag.
+    @param extended true if intersects() may return true for points outside of the rectangle of the widget.
+ */
+void Widget::setHitAreaExtended(bool extended) {
+    if (extended == m_hitAreaExtended) return;
+
+    //the parent's hit-testing data depend on the flag
+    if (m_parent && m_parent->m_spatialIndex) {
+        m_parent->m_spatialIndex->remove(this, _getHitRect());
+        m_hitAreaExtended = extended;
+        m_parent->m_spatialIndex->insert(this, _getHitRect());
+    }
+    else {
+        m_hitAreaExtended = extended;
+    }
+    if (m_parent) {
+        m_parent->m_children.update(m_slot);
+    }
 }
 
 
@@ -415,7 +1019,7 @@ WidgetPtr Widget::childFromPoint(float x, float y) const {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::leftButtonDown(int x, int y) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->leftButtonDown(x - child->getX(), y - child->getY()) : false;
 }
 
@@ -425,7 +1029,7 @@ bool Widget::leftButtonDown(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::rightButtonDown(int x, int y) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->rightButtonDown(x - child->getX(), y - child->getY()) : false;
 }
 
@@ -435,7 +1039,7 @@ bool Widget::rightButtonDown(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::middleButtonDown(int x, int y) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->middleButtonDown(x - child->getX(), y - child->getY()) : false;
 }
 
@@ -445,7 +1049,7 @@ bool Widget::middleButtonDown(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::leftButtonUp(int x, int y) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->leftButtonUp(x - child->getX(), y - child->getY()) : false;
 }
 
@@ -455,7 +1059,7 @@ bool Widget::leftButtonUp(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::rightButtonUp(int x, int y) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->rightButtonUp(x - child->getX(), y - child->getY()) : false;
 }
 
@@ -465,7 +1069,7 @@ bool Widget::rightButtonUp(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::middleButtonUp(int x, int y) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->middleButtonUp(x - child->getX(), y - child->getY()) : false;
 }
 
@@ -475,8 +1079,8 @@ bool Widget::middleButtonUp(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::mouseEnter(int x, int y) {
-    m_mouse = true;
-    WidgetPtr child = childFromPoint(x, y);
+    _setMouse(true);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->mouseEnter(x - child->getX(), y - child->getY()) : false;
 }
 
@@ -486,8 +1090,8 @@ bool Widget::mouseEnter(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::mouseMove(int x, int y) {
-    WidgetPtr oldChild = _childFromMouse();
-    WidgetPtr newChild = childFromPoint(x, y);
+    Widget *oldChild = m_mouseChild;
+    Widget *newChild = _childFromMovedMouse(x, y);
     if (newChild == oldChild) {
         return newChild && newChild->m_enabled ? newChild->mouseMove(x - newChild->getX(), y - newChild->getY()) : false;
     }
@@ -507,8 +1111,8 @@ bool Widget::mouseMove(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::mouseLeave(int x, int y) {
-    m_mouse = false;
-    WidgetPtr child = _childFromMouse();
+    _setMouse(false);
+    Widget *child = m_mouseChild;
     return child ? child->mouseLeave(x - child->getX(), y - child->getY()) : false;
 }
 
@@ -518,7 +1122,7 @@ bool Widget::mouseLeave(int x, int y) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::mouseWheel(int z, int w) {
-    WidgetPtr child = _childFromMouse();
+    Widget *child = m_mouseChild;
     return child ? child->mouseWheel(z, w) : false;
 }
 
@@ -577,13 +1181,14 @@ bool Widget::keyChar(int keycode, int unichar, int modifiers) {
 /**
     unused key down; invoked when the focus widget did not process the event;
     the default implementation dispatches the event to all children,
+    or only to the ones which are unused key targets or contain one, if the tree has unused key targets,
     stopping when the event is processed by a child.
     @return true if the event was processed, false otherwise.
  */
 bool Widget::unusedKeyDown(int keycode) {
     for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
         auto &child = *it;
-        if (child->m_enabled && child->unusedKeyDown(keycode)) {
+        if (child->m_enabled && child->_receivesUnusedKeys() && child->unusedKeyDown(keycode)) {
             return true;
         }
     }
@@ -594,13 +1199,14 @@ bool Widget::unusedKeyDown(int keycode) {
 /**
     unused key up; invoked when the focus widget did not process the event;
     the default implementation dispatches the event to all children,
+    or only to the ones which are unused key targets or contain one, if the tree has unused key targets,
     stopping when the event is processed by a child.
     @return true if the event was processed, false otherwise.
  */
 bool Widget::unusedKeyUp(int keycode) {
     for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
         auto &child = *it;
-        if (child->m_enabled && child->unusedKeyUp(keycode)) {
+        if (child->m_enabled && child->_receivesUnusedKeys() && child->unusedKeyUp(keycode)) {
             return true;
         }
     }
@@ -609,15 +1215,16 @@ bool Widget::unusedKeyUp(int keycode) {
 
 
 /**
-    unused character; invoked when the widget has the input focus;
+    unused character; invoked when neither the focus widget nor a shortcut processed the event;
     the default implementation dispatches the event to all children,
+    or only to the ones which are unused key targets or contain one, if the tree has unused key targets,
     stopping when the event is processed by a child.
     @return true if the event was processed, false otherwise.
  */
 bool Widget::unusedKeyChar(int keycode, int unichar, int modifiers) {
     for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
         auto &child = *it;
-        if (child->m_enabled && child->unusedKeyChar(keycode, unichar, modifiers)) {
+        if (child->m_enabled && child->_receivesUnusedKeys() && child->unusedKeyChar(keycode, unichar, modifiers)) {
             return true;
         }
     }
@@ -630,7 +1237,7 @@ bool Widget::unusedKeyChar(int keycode, int unichar, int modifiers) {
     @return true if the event was processed, false otherwise.
  */
 bool Widget::leftDrop(int x, int y, int modifiers, const Variant &draggedObject, const WidgetPtr &dragSource) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->leftDrop(x - child->getX(), y - child->getY(), modifiers, draggedObject, dragSource) : false;
 }
 
@@ -640,7 +1247,7 @@ bool Widget::leftDrop(int x, int y, int modifiers, const Variant &draggedObject,
     @return true if the event was processed, false otherwise.
  */
 bool Widget::rightDrop(int x, int y, int modifiers, const Variant &draggedObject, const WidgetPtr &dragSource) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->rightDrop(x - child->getX(), y - child->getY(), modifiers, draggedObject, dragSource) : false;
 }
 
@@ -650,7 +1257,7 @@ bool Widget::rightDrop(int x, int y, int modifiers, const Variant &draggedObject
     @return true if the event was processed, false otherwise.
  */
 bool Widget::middleDrop(int x, int y, int modifiers, const Variant &draggedObject, const WidgetPtr &dragSource) {
-    WidgetPtr child = childFromPoint(x, y);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->middleDrop(x - child->getX(), y - child->getY(), modifiers, draggedObject, dragSource) : false;
 }
 
@@ -660,8 +1267,8 @@ bool Widget::middleDrop(int x, int y, int modifiers, const Variant &draggedObjec
     @return true if the event was processed, false otherwise.
  */
 bool Widget::dragEnter(int x, int y, int modifiers, const Variant &draggedObject, const WidgetPtr &dragSource) {
-    m_mouse = true;
-    WidgetPtr child = childFromPoint(x, y);
+    _setMouse(true);
+    Widget *child = childFromPoint(x, y);
     return child && child->m_enabled ? child->dragEnter(x - child->getX(), y - child->getY(), modifiers, draggedObject, dragSource) : false;
 }
 
@@ -671,8 +1278,8 @@ bool Widget::dragEnter(int x, int y, int modifiers, const Variant &draggedObject
     @return true if the event was processed, false otherwise.
  */
 bool Widget::dragMove(int x, int y, int modifiers, const Variant &draggedObject, const WidgetPtr &dragSource) {
-    WidgetPtr oldChild = _childFromMouse();
-    WidgetPtr newChild = childFromPoint(x, y);
+    Widget *oldChild = m_mouseChild;
+    Widget *newChild = _childFromMovedMouse(x, y);
     if (newChild == oldChild) {
         return newChild && newChild->m_enabled ? newChild->dragMove(x - newChild->getX(), y - newChild->getY(), modifiers, draggedObject, dragSource) : false;
     }
@@ -692,8 +1299,8 @@ bool Widget::dragMove(int x, int y, int modifiers, const Variant &draggedObject,
     @return true if the event was processed, false otherwise.
  */
 bool Widget::dragLeave(int x, int y, int modifiers, const Variant &draggedObject, const WidgetPtr &dragSource) {
-    m_mouse = false;
-    WidgetPtr child = _childFromMouse();
+    _setMouse(false);
+    Widget *child = m_mouseChild;
     return child ? child->dragLeave(x - child->getX(), y - child->getY(), modifiers, draggedObject, dragSource) : false;
 }
 
@@ -703,47 +1310,183 @@ bool Widget::dragLeave(int x, int y, int modifiers, const Variant &draggedObject
     @return true if the event was processed, false otherwise.
  */
 bool Widget::dragWheel(int z, int w, int modifiers, const Variant &draggedObject, const WidgetPtr &dragSource) {
-    WidgetPtr child = _childFromMouse();
+    Widget *child = m_mouseChild;
     return child ? child->dragWheel(z, w, modifiers, draggedObject, dragSource) : false;
 }
 
 
 /**
-    Invoked on timer event.
-    This implementation passes the event to all its children.
+    Invoked on timer event, if the widget is subscribed to the timer,
+    and all its ancestors are enabled.
+    The default implementation does nothing.
     @return true if the event was processed, false otherwise.
  */
 bool Widget::timerTick(double timestamp, int64_t count) {
-    bool ok = false;
-    if (m_enabled) {
-        for(WidgetPtr &child : m_children) {
-            ok = child->timerTick(timestamp, count) || ok;
-        }
+    return false;
+}
+
+
+/**
+    Subscribes the widget to the timer.
+ */
+void Widget::subscribeTimer() {
+    if (m_timerSubscribed) return;
+    m_timerSubscribed = true;
+    _LayoutTask *task = _getLayoutTask();
+    if (task) {
+        task->timerChanges.push_back(_TimerChange{_TimerChange::Subscribe, this, nullptr});
+    }
+    else {
+        _getRootWidget()->m_timerSubscribers.push_back(this);
+    }
+}
+
+
+/**
+    Unsubscribes the widget from the timer.
+ */
+void Widget::unsubscribeTimer() {
+    if (!m_timerSubscribed) return;
+    m_timerSubscribed = false;
+    _LayoutTask *task = _getLayoutTask();
+    if (task) {
+        task->timerChanges.push_back(_TimerChange{_TimerChange::Unsubscribe, this, nullptr});
+        return;
+    }
+    std::vector<Widget *> &subscribers = _getRootWidget()->m_timerSubscribers;
+    auto it = std::find(subscribers.begin(), subscribers.end(), this);
+    if (it != subscribers.end()) {
+        subscribers.erase(it);
+    }
+}
+
+
+/**
+    Schedules a callback to be invoked after the given number of timer events.
+    @param delay number of timer events after which the callback is invoked; at least 1.
+    @param callback callback to invoke.
+    @return id of the scheduled callback.
+ */
+TimerWheel::Id Widget::schedule(uint32_t delay, const TimerWheel::Callback &callback) {
+    MutexLock lock(_getLayoutStateMutex());
+    Widget *root = _getRootWidget();
+    if (!root->m_timerWheel) {
+        root->m_timerWheel.reset(new TimerWheel);
+    }
+    return root->m_timerWheel->schedule(this, delay, callback);
+}
+
+
+/**
+    Cancels a callback scheduled by schedule().
+    @param id id of the callback.
+    @return true if the callback was cancelled, false if it was already invoked or cancelled.
+ */
+bool Widget::unschedule(TimerWheel::Id id) {
+    MutexLock lock(_getLayoutStateMutex());
+    Widget *root = _getRootWidget();
+    return root->m_timerWheel && root->m_timerWheel->getOwner(id) == this ? root->m_timerWheel->cancel(id) : false;
+}
+
+
+/**
+    Cancels all the callbacks scheduled by this widget.
+ */
+void Widget::unscheduleAll() {
+    MutexLock lock(_getLayoutStateMutex());
+    Widget *root = _getRootWidget();
+    if (root->m_timerWheel) {
+        root->m_timerWheel->cancelOwner(this);
     }
-    return ok;
 }
 
 
 /**
     Used for making the widget tree occupy the smallest possible space.
-    The default implementation simply passes the message to children.
+    The default implementation passes the message to the children that need to be packed.
     Subclasses should add the packing code after the call to the base class method.
  */
 void Widget::pack() {
-    for(WidgetPtr &child : m_children) {
-        child->pack();
+    for(const WidgetPtr &child : m_children) {
+        if (child->m_needsPack) {
+            child->_updatePack();
+        }
     }
 }
 
 
 /**
     Used for laying out widgets according to algorithms occupied by widgets.
-    The default implementation simply passes the message to children.
+    The default implementation passes the message to the children that need to be laid out,
+    or have descendants that need to be laid out.
     Subclasses should add the layout code before the call to the base class method.
  */
 void Widget::layout() {
-    for(WidgetPtr &child : m_children) {
-        child->layout();
+    if (_layoutThreadPool && _layoutChildrenInParallel()) return;
+    for(const WidgetPtr &child : m_children) {
+        if (child->m_needsLayout || child->m_descendantNeedsLayout) {
+            child->_updateLayout();
+        }
+    }
+}
+
+
+/**
+    Sets the size the widget needs, without changing the size of the widget.
+ */
+void Widget::setMeasuredSize(float width, float height) {
+    width = std::max(width, 0.f);
+    height = std::max(height, 0.f);
+    if (width == m_measuredWidth && height == m_measuredHeight) return;
+    m_measuredWidth = width;
+    m_measuredHeight = height;
+
+    //the parent must be packed again, unless this is being packed, which means the parent is too
+    if (m_parent && !m_inPack) {
+        m_parent->invalidatePack();
+    }
+}
+
+
+/**
+    Marks the widget as needing to be packed.
+ */
+void Widget::invalidatePack() {
+    for(Widget *wgt = this; wgt && !wgt->m_needsPack; wgt = wgt->m_parent) {
+        wgt->m_needsPack = true;
+
+        //when laid out in parallel, the widgets outside of the subtree are marked afterwards
+        if (_layoutTask && wgt == _layoutTask->root) {
+            _layoutTask->invalidateParentPack = true;
+            break;
+        }
+
+        if (wgt->m_parent) {
+            wgt->m_parent->invalidateLayout();
+        }
+    }
+}
+
+
+/**
+    Marks the widget as needing to be laid out.
+ */
+void Widget::invalidateLayout() {
+    if (m_needsLayout) return;
+    m_needsLayout = true;
+    _invalidateAncestorsLayout();
+}
+
+
+/**
+    Packs and lays out the parts of the tree that need it.
+ */
+void Widget::updateLayout() {
+    if (m_needsPack) {
+        _updatePack();
+    }
+    if (m_needsLayout || m_descendantNeedsLayout) {
+        _updateLayout();
     }
 }
 
@@ -753,7 +1496,9 @@ void Widget::layout() {
     The default implementation passes the call to its children.
  */
 void Widget::setSkin(const Skin &skin) {
-    for(WidgetPtr &child : m_children) {
+    //the skin may change the size of the widget
+    invalidatePack();
+    for(const WidgetPtr &child : m_children) {
         child->setSkin(skin);
     }
 }
@@ -765,15 +1510,473 @@ bool Widget::_dragAndDrop = false;
 Variant Widget::_draggedObject;
 WidgetPtr Widget::_dragAndDropSource;
 size_t Widget::_modifiers = 0;
+int Widget::_mouseWheelDeltaZ = 0;
+int Widget::_mouseWheelDeltaW = 0;
+size_t Widget::_cacheBudget = 64 * 1024 * 1024;
+size_t Widget::_cacheMemory = 0;
+Rect Widget::_drawClip = _noClip;
+bool Widget::_unusedKeyTargetsOnly = false;
+std::unordered_map<uint64_t, std::vector<Widget::_Shortcut>> Widget::_shortcuts;
+std::shared_ptr<ThreadPool> Widget::_layoutThreadPool;
+__thread Widget::_LayoutTask *Widget::_layoutTask = nullptr;
 
 
-//get child with mouse
-WidgetPtr Widget::_childFromMouse() const {
-    for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-        auto &child = *it;
-        if (child->m_mouse) return child;
+//guards the state shared by subtrees laid out in parallel, such as the timer wheel of the root and the shortcuts
+static Mutex _layoutMutex;
+
+
+//returns the mutex guarding the state shared by subtrees laid out in parallel, if the thread lays out one, or null
+Mutex *Widget::_getLayoutStateMutex() {
+    return _layoutTask ? &_layoutMutex : nullptr;
+}
+
+
+//sets the mouse flag, invalidating the widget if the flag changes
+void Widget::_setMouse(bool mouse) {
+    if (mouse == m_mouse) return;
+    m_mouse = mouse;
+    if (m_parent) {
+        m_parent->_updateMouseChild(this, mouse);
+    }
+    invalidate();
+}
+
+
+//returns the root widget, without taking a reference to it
+Widget *Widget::_getRootWidget() {
+    Widget *root = this;
+    for(; root->m_parent; root = root->m_parent);
+    return root;
+}
+
+
+//returns the rectangle the widget is put in the spatial index of its parent with;
+//a widget with an extended hit area is put in the list of large widgets, which is always searched
+const Rect &Widget::_getHitRect() const {
+    return m_hitAreaExtended ? _noClip : m_rect;
+}
+
+
+//invokes timerTick() of the subscribers in this tree
+bool Widget::_timerTick(double timestamp, int64_t count) {
+    std::vector<Widget *> &subscribers = _getRootWidget()->m_timerSubscribers;
+    if (subscribers.empty()) return false;
+
+    //the subscribers are kept alive, since a subscriber may remove or unsubscribe others
+    std::vector<WidgetPtr> ticked;
+    ticked.reserve(subscribers.size());
+    for(Widget *subscriber : subscribers) {
+        if (contains(subscriber)) {
+            ticked.push_back(subscriber->shared_from_this());
+        }
+    }
+
+    bool ok = false;
+    for(const WidgetPtr &subscriber : ticked) {
+        if (subscriber->m_timerSubscribed && contains(subscriber) && (!subscriber->m_parent || subscriber->m_parent->isEnabledTree())) {
+            ok = subscriber->timerTick(timestamp, count) || ok;
+        }
+    }
+    return ok;
+}
+
+
+//marks the ancestors as containing an unused key target;
+//an ancestor which is already marked has its own ancestors marked
+void Widget::_markUnusedKeyTargetAncestors() {
+    for(Widget *wgt = this; wgt->m_parent && !wgt->m_parent->m_descendantUnusedKeyTarget; wgt = wgt->m_parent) {
+        //when laid out in parallel, the widgets outside of the subtree are marked afterwards
+        if (_layoutTask && wgt == _layoutTask->root) break;
+        wgt->m_parent->m_descendantUnusedKeyTarget = true;
+    }
+}
+
+
+//marks the ancestors as containing a widget that must be laid out serially
+void Widget::_markSerialLayoutAncestors() {
+    for(Widget *wgt = this; wgt->m_parent && !wgt->m_parent->m_descendantSerialLayout; wgt = wgt->m_parent) {
+        //when laid out in parallel, the widgets outside of the subtree are marked afterwards
+        if (_layoutTask && wgt == _layoutTask->root) break;
+        wgt->m_parent->m_descendantSerialLayout = true;
+    }
+}
+
+
+//invokes the handlers of the shortcuts with the given key and modifiers in this tree
+bool Widget::_dispatchShortcut(int keycode, int modifiers) {
+    auto it = _shortcuts.find(_getShortcutKey(keycode, modifiers));
+    if (it == _shortcuts.end()) return false;
+
+    //the shortcuts are copied, since a handler may add or remove shortcuts, or destroy widgets
+    std::vector<std::pair<std::weak_ptr<Widget>, std::function<bool()>>> shortcuts;
+    for(auto sit = it->second.rbegin(); sit != it->second.rend(); ++sit) {
+        shortcuts.emplace_back(sit->widget->shared_from_this(), sit->handler);
+    }
+
+    for(const auto &shortcut : shortcuts) {
+        WidgetPtr widget = shortcut.first.lock();
+        if (widget && widget->m_hasShortcuts && contains(widget) && widget->isEnabledTree() && shortcut.second()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//packs the widget
+void Widget::_updatePack() {
+    m_needsPack = false;
+    m_inPack = true;
+    pack();
+    m_inPack = false;
+}
+
+
+//lays out the widget, if it needs it, and its descendants that need it
+void Widget::_updateLayout() {
+    bool needsLayout = m_needsLayout;
+    m_needsLayout = false;
+    m_descendantNeedsLayout = false;
+
+    //while the pass is within this, descendants marked as needing layout propagate the mark up to this only
+    m_inLayout = true;
+    if (needsLayout) {
+        layout();
+    }
+    else {
+        Widget::layout();
+    }
+    m_inLayout = false;
+
+    //descendants marked after the pass went through them are laid out in the next pass
+    m_descendantNeedsLayout = false;
+    for(const WidgetPtr &child : m_children) {
+        if (child->m_needsLayout || child->m_descendantNeedsLayout) {
+            m_descendantNeedsLayout = true;
+            _invalidateAncestorsLayout();
+            break;
+        }
+    }
+}
+
+
+//marks the ancestors as having descendants that need to be laid out
+void Widget::_invalidateAncestorsLayout() {
+    //the root of a subtree laid out in parallel is checked by its parent afterwards
+    if (_layoutTask && this == _layoutTask->root) return;
+
+    for(Widget *wgt = m_parent; wgt && !wgt->m_descendantNeedsLayout; wgt = wgt->m_parent) {
+        wgt->m_descendantNeedsLayout = true;
+        if (wgt->m_inLayout) break;
+    }
+}
+
+
+//lays out the children that need it in parallel, if they are enough to be worth it; returns false if they are not
+bool Widget::_layoutChildrenInParallel() {
+    //a subtree is worth a task only if the child has children itself;
+    //the subtrees which must be laid out serially are laid out by this thread, before the rest
+    std::vector<Widget *> children;
+    std::vector<Widget *> serialChildren;
+    size_t grandchildren = 0;
+    for(const WidgetPtr &child : m_children) {
+        if (child->m_needsLayout || child->m_descendantNeedsLayout) {
+            if (child->m_serialLayout || child->m_descendantSerialLayout) {
+                serialChildren.push_back(child.get());
+            }
+            else {
+                children.push_back(child.get());
+                grandchildren += child->m_children.size();
+            }
+        }
+    }
+    if (children.size() < 2 || grandchildren < _minParallelLayoutWidgets) return false;
+    for(Widget *child : serialChildren) {
+        child->_updateLayout();
+    }
+
+    //lay out each child with its own buffer for the changes outside of its subtree;
+    //a thread waiting for nested work may run another task, so the buffer of the thread is restored afterwards
+    std::vector<_LayoutTask> tasks(children.size());
+    _layoutThreadPool->parallelFor(children.size(), [&](size_t index) {
+        _LayoutTask &task = tasks[index];
+        task.root = children[index];
+        task.invalidateParentBounds = false;
+        task.invalidateParentPack = false;
+        _LayoutTask *previousTask = _layoutTask;
+        _layoutTask = &task;
+        task.root->_updateLayout();
+        _layoutTask = previousTask;
+    });
+
+    //apply the changes in the order of the children, as serial layout would;
+    //the timer changes are passed to the task this is laid out by, if any
+    _LayoutTask *parentTask = _getLayoutTask();
+    for(const _LayoutTask &task : tasks) {
+        for(const Rect &rect : task.damage) {
+            invalidateRect(rect);
+        }
+        if (task.invalidateParentBounds) {
+            _invalidateBounds();
+        }
+        if (task.invalidateParentPack) {
+            invalidateLayout();
+            invalidatePack();
+        }
+        if (task.root->_containsUnusedKeyTarget()) {
+            task.root->_markUnusedKeyTargetAncestors();
+        }
+        if (task.root->m_descendantSerialLayout) {
+            task.root->_markSerialLayoutAncestors();
+        }
+        if (parentTask) {
+            parentTask->timerChanges.insert(parentTask->timerChanges.end(), task.timerChanges.begin(), task.timerChanges.end());
+        }
+        else {
+            _applyTimerChanges(task.timerChanges);
+        }
+    }
+
+    return true;
+}
+
+
+//returns the layout task of the thread, if this is in the subtree it lays out, or null
+Widget::_LayoutTask *Widget::_getLayoutTask() {
+    if (!_layoutTask) return nullptr;
+    for(Widget *wgt = this; wgt; wgt = wgt->m_parent) {
+        if (wgt == _layoutTask->root) {
+            return _layoutTask;
+        }
+    }
+    return nullptr;
+}
+
+
+//cancels the callbacks scheduled by the tree of a removed child;
+//if requested, the timer subscribers of the tree are moved from the root to the child, which becomes a root
+void Widget::_removeTimerState(Widget *child, bool moveSubscribers) {
+    Widget *root = _getRootWidget();
+    if (root->m_timerWheel && !root->m_timerWheel->empty()) {
+        root->m_timerWheel->cancelOwners([&](const void *owner) { return child->contains(static_cast<const Widget *>(owner)); });
+    }
+
+    //the child may have subscribers already, if they subscribed after a removal that was applied later
+    if (moveSubscribers) {
+        std::vector<Widget *> &subscribers = root->m_timerSubscribers;
+        auto it = std::stable_partition(subscribers.begin(), subscribers.end(), [&](Widget *subscriber) { return !child->contains(subscriber); });
+        child->m_timerSubscribers.insert(child->m_timerSubscribers.begin(), it, subscribers.end());
+        subscribers.erase(it, subscribers.end());
+    }
+}
+
+
+//applies changes to the timer state of the root made in a subtree laid out in parallel
+void Widget::_applyTimerChanges(const std::vector<_TimerChange> &changes) {
+    std::vector<Widget *> &subscribers = _getRootWidget()->m_timerSubscribers;
+    for(const _TimerChange &change : changes) {
+        switch (change.type) {
+            case _TimerChange::Subscribe:
+                subscribers.push_back(change.widget);
+                break;
+
+            case _TimerChange::Unsubscribe: {
+                auto it = std::find(subscribers.begin(), subscribers.end(), change.widget);
+                if (it != subscribers.end()) {
+                    subscribers.erase(it);
+                }
+                break;
+            }
+
+            //a child added back to the tree keeps its subscribers in the root
+            case _TimerChange::RemoveChild:
+                _removeTimerState(change.child.get(), !change.child->m_parent);
+                break;
+        }
+    }
+}
+
+
+//updates the child with the mouse, after the mouse flag of the given child changed
+void Widget::_updateMouseChild(Widget *child, bool mouse) {
+    //the overlap of the child with the mouse must be checked again
+    m_mouseChildVersion = WidgetList::npos;
+
+    if (mouse) {
+        ++m_mouseChildCount;
+        if (!m_mouseChild || child->m_slot > m_mouseChild->m_slot) {
+            m_mouseChild = child;
+        }
+        return;
+    }
+
+    --m_mouseChildCount;
+    if (child != m_mouseChild) return;
+    m_mouseChild = nullptr;
+
+    //more than one child may have the mouse, if a child does not pass mouseLeave() to the base class;
+    //then the topmost of the rest of them is the child with the mouse
+    if (m_mouseChildCount > 0) {
+        for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
+            if ((*it)->m_mouse && it->get() != child) {
+                m_mouseChild = it->get();
+                break;
+            }
+        }
+    }
+}
+
+
+//returns the child at the given point, without searching the children while the point is within the child with the mouse
+Widget *Widget::_childFromMovedMouse(float x, float y) const {
+    Widget *child = m_mouseChild;
+    if (child &&
+        child->m_visible &&
+        (child->m_hitAreaExtended || (x >= child->getX() && x < child->getX() + child->getWidth() && y >= child->getY() && y < child->getY() + child->getHeight())) &&
+        child->intersects(x - child->getX(), y - child->getY()))
+    {
+        //the child is the topmost child at the point, unless a sibling above it overlaps it
+        if (m_mouseChildVersion != m_children.getVersion()) {
+            m_mouseChildOverlapped = m_children.isOverlapped(child->m_slot);
+            m_mouseChildVersion = m_children.getVersion();
+        }
+        if (!m_mouseChildOverlapped) {
+            return child;
+        }
+    }
+    return childFromPoint(x, y);
+}
+
+
+//adds a rectangle to the damaged areas, merging it with the rectangles it overlaps
+void Widget::_addDamage(const Rect &rect) {
+    Rect area = rect;
+
+    //merging may make the area overlap rectangles it did not overlap before, so restart after each merge
+    for(size_t i = 0; i < m_damage.size(); ) {
+        if (m_damage[i].intersects(area)) {
+            area = area.getUnion(m_damage[i]);
+            m_damage[i] = m_damage.back();
+            m_damage.pop_back();
+            i = 0;
+        }
+        else {
+            ++i;
+        }
+    }
+
+    //if there are too many areas, redraw their bounding rectangle instead
+    if (m_damage.size() >= _maxDamageRects) {
+        for(const Rect &r : m_damage) {
+            area = area.getUnion(r);
+        }
+        m_damage.clear();
+    }
+
+    m_damage.push_back(area);
+}
+
+
+//draws the widget either from its cache or directly
+void Widget::_draw(float x, float y, bool enabled, bool highlighted, bool pushed, bool selected) {
+    if (m_cached && _updateCache(enabled, highlighted, pushed, selected)) {
+        PrimitiveBatch::getCurrent()->drawBitmap(m_cacheBitmap, x + getX(), y + getY());
+    }
+    else {
+        draw(x, y, enabled, highlighted, pushed, selected);
+    }
+}
+
+
+//draws the widget into its cache; returns false if the cache cannot be used
+bool Widget::_updateCache(bool enabled, bool highlighted, bool pushed, bool selected) {
+    int width = (int)std::ceil(getWidth());
+    int height = (int)std::ceil(getHeight());
+
+    //the cache is up to date
+    if (m_cacheValid &&
+        m_cacheBitmap &&
+        al_get_bitmap_width(m_cacheBitmap) == width &&
+        al_get_bitmap_height(m_cacheBitmap) == height &&
+        m_cacheEnabled == enabled &&
+        m_cacheHighlighted == highlighted &&
+        m_cachePushed == pushed &&
+        m_cacheSelected == selected)
+    {
+        return true;
+    }
+
+    //a bitmap of a different size cannot be reused
+    if (m_cacheBitmap && (al_get_bitmap_width(m_cacheBitmap) != width || al_get_bitmap_height(m_cacheBitmap) != height)) {
+        _destroyCache();
+    }
+
+    //create the bitmap, if the budget allows it
+    if (!m_cacheBitmap) {
+        size_t bytes = (size_t)width * height * 4;
+        if (width <= 0 || height <= 0 || _cacheMemory + bytes > _cacheBudget) return false;
+        m_cacheBitmap = al_create_bitmap(width, height);
+        if (!m_cacheBitmap) return false;
+        _cacheMemory += bytes;
+    }
+
+    //draw the widget into the bitmap, at the origin;
+    //the batch is flushed before and after, since it draws to the target bitmap
+    PrimitiveBatch *batch = PrimitiveBatch::getCurrent();
+    batch->flush();
+    ALLEGRO_STATE state;
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_TRANSFORM);
+    al_set_target_bitmap(m_cacheBitmap);
+    ALLEGRO_TRANSFORM transform;
+    al_identity_transform(&transform);
+    al_use_transform(&transform);
+    al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+    Rect clip = _drawClip;
+    _drawClip = Rect(0, 0, width - 1, height - 1);
+    draw(-getX(), -getY(), enabled, highlighted, pushed, selected);
+    _drawClip = clip;
+    batch->flush();
+    al_restore_state(&state);
+
+    m_cacheValid = true;
+    m_cacheEnabled = enabled;
+    m_cacheHighlighted = highlighted;
+    m_cachePushed = pushed;
+    m_cacheSelected = selected;
+    return true;
+}
+
+
+//destroys the cache bitmap
+void Widget::_destroyCache() {
+    if (!m_cacheBitmap) return;
+    _cacheMemory -= (size_t)al_get_bitmap_width(m_cacheBitmap) * al_get_bitmap_height(m_cacheBitmap) * 4;
+    al_destroy_bitmap(m_cacheBitmap);
+    m_cacheBitmap = nullptr;
+    m_cacheValid = false;
+}
+
+
+//marks the bounds of this and its ancestors as needing to be recomputed
+void Widget::_invalidateBounds() {
+    //if a widget's bounds are invalid, then so are the bounds of its ancestors
+    for(Widget *wgt = this; wgt && wgt->m_boundsValid; wgt = wgt->m_parent) {
+        wgt->m_boundsValid = false;
+
+        //when laid out in parallel, the widgets outside of the subtree are marked afterwards
+        if (_layoutTask && wgt == _layoutTask->root) {
+            _layoutTask->invalidateParentBounds = true;
+            break;
+        }
+    }
+}
+
+
+//marks the bounds of the parent as needing to be recomputed
+void Widget::_invalidateParentBounds() {
+    if (m_parent) {
+        m_parent->_invalidateBounds();
     }
-    return WidgetPtr();
 }
 
 
@@ -2,31 +2,27 @@
 #define AMGUI_WIDGET_HPP
 
 
-#include <list>
+#include <vector>
 #include <string>
+#include <memory>
+#include <functional>
+#include <unordered_map>
 #include <allegro5/allegro.h>
 #include "Variant.hpp"
 #include "Skin.hpp"
+#include "WidgetList.hpp"
+#include "SpatialIndex.hpp"
+#include "PrimitiveBatch.hpp"
+#include "Pool.hpp"
+#include "TimerWheel.hpp"
+#include "PostQueue.hpp"
+#include "ThreadPool.hpp"
+#include "Mutex.hpp"
 
 
 namespace amgui {
 
 
-class Widget;
-
-
-/**
-    Pointer to widget.
- */
-typedef std::shared_ptr<Widget> WidgetPtr;
-
-
-/**
-    List of widgets.
- */
-typedef std::list<WidgetPtr> WidgetList;
-
-
 /**
     Base class for widgets.
  */
@@ -49,9 +45,19 @@ public:
 
     /**
         Removes this widget from its parent.
+        The children that outlive this widget are left without a parent.
      */
-    virtual ~Widget() {
-        removeFromParent();
+    virtual ~Widget();
+
+    /**
+        Creates a widget of the given type.
+        The widget and its reference count are allocated together from a pool,
+        which is faster than allocating them from the heap, and keeps widgets close together in memory.
+        @param args arguments to pass to the constructor of the widget.
+        @return pointer to the new widget.
+     */
+    template <class T, class... Args> static std::shared_ptr<T> create(Args&&... args) {
+        return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
     }
 
     /**
@@ -83,18 +89,30 @@ public:
         Returns a pointer to parent.
      */
     WidgetPtr getParent() const {
-        return m_parent.lock();
+        return m_parent ? m_parent->shared_from_this() : WidgetPtr();
     }
 
     /**
         Returns the previous sibling.
      */
-    WidgetPtr getPrevSibling() const;
+    WidgetPtr getPrevSibling() const {
+        if (m_parent) {
+            size_t slot = m_parent->m_children.getPrevSlot(m_slot);
+            if (slot != WidgetList::npos) return m_parent->m_children[slot];
+        }
+        return WidgetPtr();
+    }
 
     /**
         Returns the next sibling.
      */
-    WidgetPtr getNextSibling() const;
+    WidgetPtr getNextSibling() const {
+        if (m_parent) {
+            size_t slot = m_parent->m_children.getNextSlot(m_slot);
+            if (slot != WidgetList::npos) return m_parent->m_children[slot];
+        }
+        return WidgetPtr();
+    }
 
     /**
         Returns the first child.
@@ -125,7 +143,14 @@ public:
     /**
         Returns true if this widget tree contains the given widget.
      */
-    bool contains(const WidgetPtr &wgt) const;
+    bool contains(const Widget *wgt) const;
+
+    /**
+        Returns true if this widget tree contains the given widget.
+     */
+    bool contains(const WidgetPtr &wgt) const {
+        return contains(wgt.get());
+    }
 
     /**
         Adds a widget as a child.
@@ -244,9 +269,7 @@ public:
     /**
         Sets the visible flag.
      */
-    virtual void setVisible(bool visible) {
-        m_visible = visible;
-    }
+    virtual void setVisible(bool visible);
 
     /**
         Retrieves the enabled flag.
@@ -276,6 +299,8 @@ public:
         The default implementation draws the children.
         Subclasses may add the drawing code before calling the default implementation
         to draw the children.
+        Subclasses should draw primitives through PrimitiveBatch::getCurrent(),
+        flushing it before drawing anything else.
         @param x base x coordinate to draw the widget upon.
         @param y base y coordinate to draw the widget upon.
         @param enabled if true, then the widget and all ancestors of it are enabled.
@@ -287,17 +312,138 @@ public:
 
     /**
         Draws this widget at the current X and Y of the widget, using the widget properties as parameters.
+        If the widget is cached, then its cache is drawn instead.
+        Children that are entirely outside of the target bitmap's clipping rectangle are not drawn.
+        The current primitive batch is flushed afterwards.
+     */
+    void draw();
+
+    /**
+        Returns the area occupied by this widget and its visible descendants, relative to this widget.
+        The area is cached and updated only when the rectangles, visibility or children of the subtree change.
+     */
+    const Rect &getSubtreeBounds() const;
+
+    /**
+        Returns true if the children are clipped to the rectangle of this widget.
+     */
+    bool isClipChildren() const {
+        return m_clipChildren;
+    }
+
+    /**
+        Sets the clip children flag.
+        If set, then the children are drawn clipped to the rectangle of this widget,
+        and children outside of the rectangle are not drawn at all.
+        Useful for scrolling views over big content.
+     */
+    void setClipChildren(bool clip);
+
+    /**
+        Returns true if the widget is cached.
+     */
+    bool isCached() const {
+        return m_cached;
+    }
+
+    /**
+        Sets the cached flag.
+        A cached widget draws itself and its children into a bitmap once,
+        then draws the bitmap until the widget or one of its descendants is invalidated.
+        Drawing outside of the widget's rectangle is clipped.
+        If the bitmap would exceed the cache budget, or it cannot be created,
+        then the widget is drawn directly.
+     */
+    void setCached(bool cached);
+
+    /**
+        Returns the maximum number of bytes all the widget caches may use.
+     */
+    static size_t getCacheBudget() {
+        return _cacheBudget;
+    }
+
+    /**
+        Sets the maximum number of bytes all the widget caches may use.
+        Caches already created are not released; they are only prevented from growing.
+     */
+    static void setCacheBudget(size_t bytes) {
+        _cacheBudget = bytes;
+    }
+
+    /**
+        Returns the number of bytes all the widget caches currently use.
+     */
+    static size_t getCacheMemory() {
+        return _cacheMemory;
+    }
+
+    /**
+        Marks the whole area of the widget as needing to be redrawn.
      */
-    void draw() {
-        draw(getX(), getY(), true, m_mouse, m_pushed, m_selected);
+    void invalidate() {
+        invalidateRect(Rect(0, 0, getWidth() - 1, getHeight() - 1));
     }
 
+    /**
+        Marks an area of the widget as needing to be redrawn.
+        The area is recorded in the root widget of the tree, in the coordinates the root widget is drawn in.
+        Nothing is recorded if the widget or one of its ancestors is invisible.
+        @param rect rectangle to redraw, relative to the widget.
+     */
+    void invalidateRect(const Rect &rect);
+
+    /**
+        Returns true if there are areas of this widget tree that need to be redrawn.
+        Valid only for the root widget.
+     */
+    bool hasDamage() const {
+        return !m_damage.empty();
+    }
+
+    /**
+        Returns the areas of this widget tree that need to be redrawn.
+        Valid only for the root widget.
+     */
+    const std::vector<Rect> &getDamage() const {
+        return m_damage;
+    }
+
+    /**
+        Redraws the areas that need to be redrawn, using clipping, then clears the list of damaged areas.
+        Valid only for the root widget, which should paint its whole area,
+        since the damaged areas are not cleared before drawing.
+        @return true if something was drawn, false if there was no damage.
+     */
+    bool redraw();
+
     /**
         dispatches the given allegro event, to the various event methods of this widget.
         @return true if the event was used by a widget, false otherwise.
      */
     virtual bool dispatch(ALLEGRO_EVENT *event);
 
+    /**
+        Dispatches all the events that are currently in the given queue.
+        Consecutive mouse motion events from the same source are merged into one event,
+        which has the latest position and the sum of the relative movements,
+        so as that a fast mouse does not cause a widget tree traversal per event.
+        All other events are dispatched one by one, in their original order.
+        @param queue queue to take the events from; it is not waited on.
+        @param filter optional function invoked for each event before it is dispatched;
+            if it returns true, then the event is not dispatched to the widgets.
+        @return the number of events merged into other events.
+     */
+    size_t dispatchQueue(ALLEGRO_EVENT_QUEUE *queue, const std::function<bool(ALLEGRO_EVENT &)> &filter = nullptr);
+
+    /**
+        Returns the post queue of this widget, creating it if it does not exist.
+        Other threads may post functions to the queue, which are invoked when this widget dispatches the queue's events;
+        so it should be used on the root of the gui, and its event source must be registered to the event queue.
+        The queue itself must be obtained from the gui thread; it may be kept and used by any thread.
+     */
+    const std::shared_ptr<PostQueue> &getPostQueue();
+
     /**
         Returns true if this widget has the input focus.
      */
@@ -321,9 +467,7 @@ public:
     /**
         Sets the widget to the pushed state.
      */
-    virtual void setPushed(bool pushed) {
-        m_pushed = pushed;
-    }
+    virtual void setPushed(bool pushed);
 
     /**
         Check if the widget is in selected state.
@@ -335,10 +479,48 @@ public:
     /**
         Sets the widget to the selected state.
      */
-    virtual void setSelected(bool selected) {
-        m_selected = selected;
+    virtual void setSelected(bool selected);
+
+    /**
+        Adds a keyboard shortcut to this widget.
+        When a character event is not processed by the focus widget, the shortcuts of the event's key and modifiers are looked up,
+        and the handlers of the ones whose widget is in the dispatching tree, with all its ancestors enabled, are invoked,
+        most recently added first, until one returns true; if none does, unusedKeyChar() is invoked as before.
+        Shortcuts are looked up in a hash table, so their cost does not depend on the size of the tree.
+        Key down and key up events are not looked up, since allegro reports the modifiers only on character events,
+        which also repeat as shortcuts do; widgets which need those events override the unused key methods instead.
+        @param keycode allegro key code.
+        @param modifiers modifiers which must be pressed, such as ALLEGRO_KEYMOD_CTRL; lock keys are ignored.
+        @param handler function to invoke; it returns true if the key was processed.
+     */
+    void addShortcut(int keycode, int modifiers, const std::function<bool()> &handler);
+
+    /**
+        Removes the shortcuts of this widget with the given key and modifiers.
+     */
+    void removeShortcut(int keycode, int modifiers);
+
+    /**
+        Removes all the shortcuts of this widget.
+     */
+    void removeAllShortcuts();
+
+    /**
+        Returns true if the widget receives the key events that neither the focus widget nor a shortcut processes.
+     */
+    bool isUnusedKeyTarget() const {
+        return m_unusedKeyTarget;
     }
 
+    /**
+        Sets the unused key target flag.
+        By default, unused key events are dispatched to every widget of the tree.
+        Once a widget of the tree sets the flag, they reach only the widgets which set it and their ancestors,
+        so a key event which nothing processes does not visit the rest of the tree.
+        @param target true if unusedKeyDown(), unusedKeyUp() and unusedKeyChar() are to be invoked for the widget.
+     */
+    void setUnusedKeyTarget(bool target);
+
     /**
         Returns true if drag-n-drop is in progress.
      */
@@ -369,16 +551,52 @@ public:
 
     /**
         Returns the child with the given coordinates.
+        If more than one children contain the point, the topmost one is returned.
+        The returned pointer does not own the child; it is valid as long as the child is not removed.
+     */
+    Widget *childFromPoint(float x, float y) const;
+
+    /**
+        Returns true if this widget keeps a spatial index of its children.
      */
-    WidgetPtr childFromPoint(float x, float y) const;
+    bool hasSpatialIndex() const {
+        return (bool)m_spatialIndex;
+    }
+
+    /**
+        Enables or disables the spatial index of children.
+        The index makes childFromPoint() run in roughly constant time,
+        which is useful for containers with many children.
+        @param enabled true to enable the index, false to disable it.
+        @param cellSize size of the cells of the index, in pixels.
+     */
+    void setSpatialIndex(bool enabled, float cellSize = 64);
 
     /**
         Checks if the widget intersects the given point.
+        When looking for a child at a point, it is invoked only for children whose rectangle contains the point,
+        so it may narrow the rectangle to the shape of the widget;
+        widgets which override it to extend beyond their rectangle must set the extended hit area flag.
      */
     virtual bool intersects(float x, float y) const {
         return x >= 0 && x < getWidth() && y >= 0 && y < getHeight();
     }
 
+    /**
+        Returns true if the widget may intersect points outside of its rectangle.
+     */
+    bool isHitAreaExtended() const {
+        return m_hitAreaExtended;
+    }
+
+    /**
+        Sets the extended hit area flag.
+        When it is set, looking for a child at a point invokes intersects() of the widget
+        wherever the point is, instead of only when the rectangle of the widget contains the point.
+        @param extended true if intersects() may return true for points outside of the rectangle of the widget.
+     */
+    void setHitAreaExtended(bool extended);
+
     /**
         Left button down; the default implementation dispatches the event to children.
         @return true if the event was processed, false otherwise.
@@ -435,10 +653,25 @@ public:
 
     /**
         mouse wheel; the default implementation dispatches the event to the child that contains the mouse.
+        The change of the wheel positions is available from getMouseWheelDeltaZ() and getMouseWheelDeltaW().
         @return true if the event was processed, false otherwise.
      */
     virtual bool mouseWheel(int z, int w);
 
+    /**
+        Returns the change of the vertical wheel position in the mouse event being dispatched.
+     */
+    static int getMouseWheelDeltaZ() {
+        return _mouseWheelDeltaZ;
+    }
+
+    /**
+        Returns the change of the horizontal wheel position in the mouse event being dispatched.
+     */
+    static int getMouseWheelDeltaW() {
+        return _mouseWheelDeltaW;
+    }
+
     /**
         Invoked when the widget lost the focus.
         @return false to prevent the widget from losing the focus, true otherwise.
@@ -477,6 +710,7 @@ public:
     /**
         unused key down; invoked when the focus widget did not process the event;
         the default implementation dispatches the event to all children,
+        or only to the ones which are unused key targets or contain one, if the tree has unused key targets,
         stopping when the event is processed by a child.
         @return true if the event was processed, false otherwise.
      */
@@ -485,14 +719,16 @@ public:
     /**
         unused key up; invoked when the focus widget did not process the event;
         the default implementation dispatches the event to all children,
+        or only to the ones which are unused key targets or contain one, if the tree has unused key targets,
         stopping when the event is processed by a child.
         @return true if the event was processed, false otherwise.
      */
     virtual bool unusedKeyUp(int keycode);
 
     /**
-        unused character; invoked when the widget has the input focus;
+        unused character; invoked when neither the focus widget nor a shortcut processed the event;
         the default implementation dispatches the event to all children,
+        or only to the ones which are unused key targets or contain one, if the tree has unused key targets,
         stopping when the event is processed by a child.
         @return true if the event was processed, false otherwise.
      */
@@ -541,26 +777,176 @@ public:
     virtual bool dragWheel(int z, int w, int modifiers, const Variant &draggedObject, const WidgetPtr &dragSource);
 
     /**
-        Invoked on timer event.
-        This implementation passes the event to all its children.
+        Invoked on timer event, if the widget is subscribed to the timer,
+        and all its ancestors are enabled.
+        The default implementation does nothing.
         @return true if the event was processed, false otherwise.
      */
     virtual bool timerTick(double timestamp, int64_t count);
 
+    /**
+        Returns true if the widget is subscribed to the timer.
+     */
+    bool isTimerSubscribed() const {
+        return m_timerSubscribed;
+    }
+
+    /**
+        Subscribes the widget to the timer, so as that timerTick() is invoked on timer events.
+        The subscribers are kept by the root of the tree, so a timer event reaches only the subscribers,
+        without visiting the rest of the tree.
+     */
+    void subscribeTimer();
+
+    /**
+        Unsubscribes the widget from the timer.
+     */
+    void unsubscribeTimer();
+
+    /**
+        Schedules a callback to be invoked after the given number of timer events.
+        The callbacks are kept by the root of the tree, in a timer wheel, which the root advances by one tick per timer event;
+        so widgets that need a delay, for example for tooltips or key repeat, do not have to count timer ticks themselves.
+        The callbacks of a widget are cancelled when the widget, or an ancestor of it, is removed from its parent,
+        and when the root of its tree is added to another widget.
+        Callbacks should not keep pointers to the widget, since the tree would then keep itself alive.
+        @param delay number of timer events after which the callback is invoked; at least 1.
+        @param callback callback to invoke.
+        @return id of the scheduled callback.
+     */
+    TimerWheel::Id schedule(uint32_t delay, const TimerWheel::Callback &callback);
+
+    /**
+        Cancels a callback scheduled by schedule().
+        @param id id of the callback.
+        @return true if the callback was cancelled, false if it was already invoked or cancelled.
+     */
+    bool unschedule(TimerWheel::Id id);
+
+    /**
+        Cancels all the callbacks scheduled by this widget.
+     */
+    void unscheduleAll();
+
     /**
         Used for making the widget tree occupy the smallest possible space.
-        The default implementation simply passes the message to children.
+        The default implementation passes the message to the children that need to be packed.
         Subclasses should add the packing code after the call to the base class method.
      */
     virtual void pack();
 
     /**
         Used for laying out widgets according to algorithms occupied by widgets.
-        The default implementation simply passes the message to children.
+        The default implementation passes the message to the children that need to be laid out,
+        or have descendants that need to be laid out.
         Subclasses should add the layout code before the call to the base class method.
      */
     virtual void layout();
 
+    /**
+        Returns the width the widget needs.
+        It is the width the widget was last given by something other than the layout of its parent,
+        usually by its own pack() method, or the one set by setMeasuredSize();
+        layout containers use it to measure their children.
+     */
+    float getMeasuredWidth() const {
+        return m_measuredWidth;
+    }
+
+    /**
+        Returns the height the widget needs.
+        It is the height the widget was last given by something other than the layout of its parent,
+        usually by its own pack() method, or the one set by setMeasuredSize();
+        layout containers use it to measure their children.
+     */
+    float getMeasuredHeight() const {
+        return m_measuredHeight;
+    }
+
+    /**
+        Sets the size the widget needs, without changing the size of the widget.
+        Layout containers call it from pack(), so as that their size is left to the layout of their parent.
+        If the measured size changes, the parent is marked as needing to be packed.
+     */
+    void setMeasuredSize(float width, float height);
+
+    /**
+        Returns true if the widget needs to be packed.
+     */
+    bool needsPack() const {
+        return m_needsPack;
+    }
+
+    /**
+        Returns true if the widget needs to be laid out.
+     */
+    bool needsLayout() const {
+        return m_needsLayout;
+    }
+
+    /**
+        Marks the widget as needing to be packed, for example because its content changed.
+        The ancestors of the widget are marked too, since their size depends on the size of the widget,
+        and the parent is marked as needing to be laid out.
+     */
+    void invalidatePack();
+
+    /**
+        Marks the widget as needing to be laid out.
+        Changing the size of the widget, or adding and removing children, does that automatically.
+     */
+    void invalidateLayout();
+
+    /**
+        Returns the thread pool used for laying out widgets in parallel; null by default.
+     */
+    static const std::shared_ptr<ThreadPool> &getLayoutThreadPool() {
+        return _layoutThreadPool;
+    }
+
+    /**
+        Sets the thread pool used for laying out widgets in parallel.
+        When the children that need to be laid out are enough to be worth it,
+        the default layout() method lays out their subtrees as tasks of the pool.
+        The changes a subtree causes outside of itself, such as damage, are kept per subtree,
+        and applied in the order of the children after all of them are laid out,
+        so as that the result is the same as that of laying them out one after the other.
+        The layout code of widgets must then change only the widgets of its own subtree,
+        and must not use drawing state, such as the target bitmap, or any other state shared between widgets.
+        Adding and removing children, subscribing to the timer and scheduling callbacks are allowed:
+        the changes to the timer subscribers of the root are applied afterwards, in the order of the children,
+        and removed children are kept alive until then, so as that they are destroyed by the thread that started the layout;
+        callbacks and shortcuts are registered under a lock, so the order of the ones registered by different subtrees is unspecified.
+        @param pool thread pool; if null, widgets are laid out serially.
+     */
+    static void setLayoutThreadPool(const std::shared_ptr<ThreadPool> &pool) {
+        _layoutThreadPool = pool;
+    }
+
+    /**
+        Returns true if the widget must be laid out by the thread that started the layout.
+     */
+    bool isSerialLayout() const {
+        return m_serialLayout;
+    }
+
+    /**
+        Sets the serial layout flag.
+        A child whose subtree contains a widget with the flag is not laid out in parallel with its siblings;
+        it is for widgets whose layout calls code that is not thread-safe, such as the data source of a list view.
+        The flag must be set before the widget is laid out.
+        @param serial true if the widget must be laid out by the thread that started the layout.
+     */
+    void setSerialLayout(bool serial);
+
+    /**
+        Packs and lays out the parts of the tree that need it.
+        Only the widgets marked as needing to be packed or laid out, and their ancestors, are visited,
+        so changing a single widget does not cost a pass over the whole tree.
+        It is meant to be called on the root once per frame, before drawing.
+     */
+    void updateLayout();
+
     /**
         A widget can retrieve its gui data from the given skin.
         The default implementation passes the call to its children.
@@ -571,24 +957,98 @@ private:
     //mainly used for debugging
     std::string m_id;
 
-    //parent
-    std::weak_ptr<Widget> m_parent;
+    //parent; not owned, since the parent owns this, and it clears the pointer when destroyed
+    Widget *m_parent;
 
     //children
     WidgetList m_children;
 
-    //position into parent
-    WidgetList::iterator m_it;
+    //slot into parent's children list; also used as z-order by the parent's spatial index
+    size_t m_slot;
+
+    //the topmost child with the mouse, and the number of children with the mouse;
+    //the children with the mouse form a path from the root to the widget under the mouse
+    Widget *m_mouseChild;
+    size_t m_mouseChildCount;
+
+    //version of the children list for which it is known if a sibling overlaps the child with the mouse
+    mutable size_t m_mouseChildVersion;
 
     //position and size
     Rect m_rect;
 
+    //index of children; optional
+    std::unique_ptr<SpatialIndex> m_spatialIndex;
+
+    //areas to redraw; used only by the root widget
+    std::vector<Rect> m_damage;
+
+    //widgets of the tree subscribed to the timer; used only by the root widget
+    std::vector<Widget *> m_timerSubscribers;
+
+    //callbacks scheduled by the widgets of the tree; used only by the root widget; created on demand;
+    //shared, so as that it is kept alive while it is advanced
+    std::shared_ptr<TimerWheel> m_timerWheel;
+
+    //functions posted by other threads; created on demand
+    std::shared_ptr<PostQueue> m_postQueue;
+
+    //drawing cache
+    ALLEGRO_BITMAP *m_cacheBitmap;
+
+    //area occupied by this and its visible descendants
+    mutable Rect m_bounds;
+
     //state
     bool m_visible:1;
     bool m_enabled:1;
     bool m_mouse:1;
     bool m_pushed:1;
     bool m_selected:1;
+    bool m_cached:1;
+    bool m_cacheValid:1;
+
+    //the drawing parameters the cache was drawn with
+    bool m_cacheEnabled:1;
+    bool m_cacheHighlighted:1;
+    bool m_cachePushed:1;
+    bool m_cacheSelected:1;
+
+    //bounds state
+    bool m_clipChildren:1;
+    mutable bool m_boundsValid:1;
+
+    //timer state
+    bool m_timerSubscribed:1;
+
+    //size the widget needs
+    float m_measuredWidth;
+    float m_measuredHeight;
+
+    //layout state
+    bool m_inPack:1;
+    bool m_needsPack:1;
+    bool m_needsLayout:1;
+    bool m_descendantNeedsLayout:1;
+    bool m_inLayout:1;
+
+    //true if the widget has shortcuts
+    bool m_hasShortcuts:1;
+
+    //true if the widget receives unused key events, and if a descendant may;
+    //the latter is not cleared when the descendant stops receiving them or is removed, which only costs a visit
+    bool m_unusedKeyTarget:1;
+    bool m_descendantUnusedKeyTarget:1;
+
+    //true if the widget must be laid out by the thread that started the layout, and if a descendant may
+    bool m_serialLayout:1;
+    bool m_descendantSerialLayout:1;
+
+    //true if a sibling above the child with the mouse overlaps it
+    mutable bool m_mouseChildOverlapped:1;
+
+    //true if intersects() may return true outside of the rectangle
+    bool m_hitAreaExtended:1;
 
     //global state
     static std::weak_ptr<Widget> _focusWidget;
@@ -596,9 +1056,132 @@ private:
     static Variant _draggedObject;
     static WidgetPtr _dragAndDropSource;
     static size_t _modifiers;
+    static int _mouseWheelDeltaZ;
+    static int _mouseWheelDeltaW;
+    static size_t _cacheBudget;
+    static size_t _cacheMemory;
+    static Rect _drawClip;
+
+    //true if the unused key event being dispatched is for unused key targets only, because its tree has some
+    static bool _unusedKeyTargetsOnly;
+
+    //shortcut
+    struct _Shortcut {
+        Widget *widget;
+        std::function<bool()> handler;
+    };
+
+    //shortcuts, by key and modifiers
+    static std::unordered_map<uint64_t, std::vector<_Shortcut>> _shortcuts;
+
+    //change to the timer state of the root, made in a subtree laid out in parallel
+    struct _TimerChange {
+        enum Type {
+            Subscribe,
+            Unsubscribe,
+            RemoveChild
+        };
+        Type type;
+        Widget *widget;
+
+        //a removed child is kept alive until the change is applied, so as that it is destroyed by the thread that started the layout
+        WidgetPtr child;
+    };
+
+    //changes caused outside of a subtree laid out in parallel
+    struct _LayoutTask {
+        Widget *root;
+        std::vector<Rect> damage;
+        bool invalidateParentBounds;
+        bool invalidateParentPack;
+        std::vector<_TimerChange> timerChanges;
+    };
+
+    //parallel layout state
+    static std::shared_ptr<ThreadPool> _layoutThreadPool;
+    static __thread _LayoutTask *_layoutTask;
+
+    friend class WidgetList;
+
+    //sets the mouse flag, invalidating the widget if the flag changes
+    void _setMouse(bool mouse);
+
+    //returns the rectangle the widget is put in the spatial index of its parent with
+    const Rect &_getHitRect() const;
+
+    //updates the child with the mouse, after the mouse flag of the given child changed
+    void _updateMouseChild(Widget *child, bool mouse);
+
+    //returns the child at the given point, without searching the children while the point is within the child with the mouse
+    Widget *_childFromMovedMouse(float x, float y) const;
+
+    //returns the root widget, without taking a reference to it
+    Widget *_getRootWidget();
+
+    //invokes timerTick() of the subscribers in this tree
+    bool _timerTick(double timestamp, int64_t count);
+
+    //returns true if the widget is an unused key target or contains one
+    bool _containsUnusedKeyTarget() const {
+        return m_unusedKeyTarget || m_descendantUnusedKeyTarget;
+    }
+
+    //returns true if the unused key event being dispatched is dispatched to this widget
+    bool _receivesUnusedKeys() const {
+        return !_unusedKeyTargetsOnly || _containsUnusedKeyTarget();
+    }
+
+    //marks the ancestors as containing an unused key target
+    void _markUnusedKeyTargetAncestors();
+
+    //marks the ancestors as containing a widget that must be laid out serially
+    void _markSerialLayoutAncestors();
+
+    //invokes the handlers of the shortcuts with the given key and modifiers in this tree
+    bool _dispatchShortcut(int keycode, int modifiers);
+
+    //packs the widget
+    void _updatePack();
+
+    //lays out the widget, if it needs it, and its descendants that need it
+    void _updateLayout();
+
+    //marks the ancestors as having descendants that need to be laid out
+    void _invalidateAncestorsLayout();
+
+    //lays out the children that need it in parallel, if they are enough to be worth it; returns false if they are not
+    bool _layoutChildrenInParallel();
+
+    //returns the layout task of the thread, if this is in the subtree it lays out, or null
+    _LayoutTask *_getLayoutTask();
+
+    //returns the mutex guarding the state shared by subtrees laid out in parallel, if the thread lays out one, or null
+    static Mutex *_getLayoutStateMutex();
+
+    //cancels the callbacks scheduled by the tree of a removed child;
+    //if requested, the timer subscribers of the tree are moved from the root to the child, which becomes a root
+    void _removeTimerState(Widget *child, bool moveSubscribers);
+
+    //applies changes to the timer state of the root made in a subtree laid out in parallel
+    void _applyTimerChanges(const std::vector<_TimerChange> &changes);
+
+    //adds a rectangle to the damaged areas, merging it with the rectangles it overlaps
+    void _addDamage(const Rect &rect);
+
+    //draws the widget either from its cache or directly
+    void _draw(float x, float y, bool enabled, bool highlighted, bool pushed, bool selected);
+
+    //draws the widget into its cache; returns false if the cache cannot be used
+    bool _updateCache(bool enabled, bool highlighted, bool pushed, bool selected);
+
+    //destroys the cache bitmap
+    void _destroyCache();
+
+    //marks the bounds of this and its ancestors as needing to be recomputed
+    void _invalidateBounds();
 
-    //get child with mouse
-    WidgetPtr _childFromMouse() const;
+    //marks the bounds of the parent as needing to be recomputed
+    void _invalidateParentBounds();
 };
 
 
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <limits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "WidgetList.hpp"
+#include "Widget.hpp"
+
+
+namespace amgui {
+
+
+//the empty slots are not reclaimed while they are less than this
+static const size_t _minEmptySlots = 16;
+
+
+//value returned by hitTest() when no widget contains the point
+const size_t WidgetList::npos;
+
+
+/**
+    Inserts a widget.
+    @param slot the widget is inserted before the widget at this slot.
+    @param widget widget to insert.
+ */
+void WidgetList::insert(size_t slot, const WidgetPtr &widget) {
+    //reclaim the empty slots if there are more of them than widgets
+    if (m_slots.size() - m_count > std::max(m_count, _minEmptySlots)) {
+        size_t position = 0;
+        for(size_t i = 0; i < slot && i < m_slots.size(); ++i) {
+            if (m_slots[i]) ++position;
+        }
+        _compact();
+        slot = position;
+    }
+
+    //an empty slot right before the insertion point keeps the order, so reuse it
+    if (slot > 0 && slot <= m_slots.size() && !m_slots[slot - 1]) {
+        --slot;
+        m_slots[slot] = widget;
+        widget->m_slot = slot;
+    }
+
+    //append
+    else if (slot >= m_slots.size()) {
+        slot = m_slots.size();
+        widget->m_slot = slot;
+        m_slots.push_back(widget);
+        m_left.push_back(0);
+        m_top.push_back(0);
+        m_right.push_back(0);
+        m_bottom.push_back(0);
+    }
+
+    //insert in the middle; the following widgets move one slot forward
+    else {
+        m_slots.insert(m_slots.begin() + slot, widget);
+        m_left.insert(m_left.begin() + slot, 0);
+        m_top.insert(m_top.begin() + slot, 0);
+        m_right.insert(m_right.begin() + slot, 0);
+        m_bottom.insert(m_bottom.begin() + slot, 0);
+        _updateSlots(slot);
+    }
+
+    _storeRect(slot);
+    ++m_count;
+    ++m_version;
+}
+
+
+/**
+    Removes the widget at the given slot, in O(1) time.
+ */
+void WidgetList::erase(size_t slot) {
+    m_slots[slot].reset();
+    _storeRect(slot);
+    --m_count;
+    ++m_version;
+
+    //if the list becomes empty, the slots can be dropped without moving any widget
+    if (m_count == 0) {
+        m_slots.clear();
+        m_left.clear();
+        m_top.clear();
+        m_right.clear();
+        m_bottom.clear();
+    }
+}
+
+
+/**
+    Updates the hit-testing data of the widget at the given slot.
+ */
+void WidgetList::update(size_t slot) {
+    _storeRect(slot);
+    ++m_version;
+}
+
+
+/**
+    Finds the topmost visible widget whose rectangle contains the given point,
+    among the widgets before the given slot.
+    @param x x coordinate, relative to the parent.
+    @param y y coordinate, relative to the parent.
+    @param before the search starts from the slot before this one.
+    @return the slot of the widget, or npos if there is none.
+ */
+size_t WidgetList::hitTest(float x, float y, size_t before/* = npos*/) const {
+    size_t slot = std::min(before, m_slots.size());
+
+#ifdef __SSE2__
+    //test blocks of four slots, from the top down
+    const __m128 px = _mm_set1_ps(x);
+    const __m128 py = _mm_set1_ps(y);
+    for(; slot >= 4; slot -= 4) {
+        size_t first = slot - 4;
+        __m128 inX = _mm_and_ps(_mm_cmpge_ps(px, _mm_loadu_ps(&m_left[first])), _mm_cmplt_ps(px, _mm_loadu_ps(&m_right[first])));
+        __m128 inY = _mm_and_ps(_mm_cmpge_ps(py, _mm_loadu_ps(&m_top[first])), _mm_cmplt_ps(py, _mm_loadu_ps(&m_bottom[first])));
+        int mask = _mm_movemask_ps(_mm_and_ps(inX, inY));
+        if (mask) {
+            for(int i = 3; ; --i) {
+                if (mask & (1 << i)) return first + i;
+            }
+        }
+    }
+#endif
+
+    //test the remaining slots
+    while (slot > 0) {
+        --slot;
+        if (x >= m_left[slot] && x < m_right[slot] && y >= m_top[slot] && y < m_bottom[slot]) {
+            return slot;
+        }
+    }
+
+    return npos;
+}
+
+
+/**
+    Returns true if a visible widget after the given slot overlaps the rectangle of the widget at the slot.
+ */
+bool WidgetList::isOverlapped(size_t slot) const {
+    for(size_t i = slot + 1; i < m_slots.size(); ++i) {
+        if (m_left[i] < m_right[slot] && m_left[slot] < m_right[i] && m_top[i] < m_bottom[slot] && m_top[slot] < m_bottom[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//removes the empty slots
+void WidgetList::_compact() {
+    m_slots.erase(std::remove(m_slots.begin(), m_slots.end(), nullptr), m_slots.end());
+    m_left.resize(m_slots.size());
+    m_top.resize(m_slots.size());
+    m_right.resize(m_slots.size());
+    m_bottom.resize(m_slots.size());
+    _updateSlots(0);
+    for(size_t i = 0; i < m_slots.size(); ++i) {
+        _storeRect(i);
+    }
+}
+
+
+//updates the slot of the widgets from the given slot onwards
+void WidgetList::_updateSlots(size_t first) {
+    for(size_t i = first; i < m_slots.size(); ++i) {
+        if (m_slots[i]) {
+            m_slots[i]->m_slot = i;
+        }
+    }
+}
+
+
+//copies the rectangle of the widget at the given slot to the coordinate arrays;
+//a widget with an extended hit area gets an infinite rectangle, so as that it is a candidate for every point
+void WidgetList::_storeRect(size_t slot) {
+    const Widget *widget = m_slots[slot].get();
+    if (widget && widget->m_visible && widget->m_hitAreaExtended) {
+        m_left[slot] = m_top[slot] = -std::numeric_limits<float>::infinity();
+        m_right[slot] = m_bottom[slot] = std::numeric_limits<float>::infinity();
+    }
+    else if (widget && widget->m_visible) {
+        m_left[slot] = widget->getX();
+        m_top[slot] = widget->getY();
+        m_right[slot] = widget->getX() + widget->getWidth();
+        m_bottom[slot] = widget->getY() + widget->getHeight();
+    }
+    else {
+        m_left[slot] = m_top[slot] = m_right[slot] = m_bottom[slot] = 0;
+    }
+}
+
+
+} //namespace amgui
@@ -0,0 +1,338 @@
+#ifndef AMGUI_WIDGETLIST_HPP
+#define AMGUI_WIDGETLIST_HPP
+
+
+#include <memory>
+#include <vector>
+#include <iterator>
+
+
+namespace amgui {
+
+
+class Widget;
+
+
+/**
+    Pointer to widget.
+ */
+typedef std::shared_ptr<Widget> WidgetPtr;
+
+
+/**
+    List of widgets.
+    The widgets are stored contiguously, in order, and each widget knows its slot in the list,
+    so traversal is cache-friendly and removal is O(1): a removed widget leaves an empty slot behind,
+    which iteration skips. Empty slots are reclaimed when enough of them accumulate and a widget is inserted.
+    Iterators hold indices, so they are not invalidated by reallocation.
+    The rectangles of the visible widgets are mirrored in separate arrays of coordinates,
+    so as that hit-testing many widgets touches only the memory it needs, and it can test several widgets at once.
+ */
+class WidgetList {
+public:
+    /**
+        Iterator over the widgets of the list.
+     */
+    class const_iterator {
+    public:
+        //iterator traits
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef WidgetPtr value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const WidgetPtr *pointer;
+        typedef const WidgetPtr &reference;
+
+        /**
+            The default constructor.
+         */
+        const_iterator() : m_list(nullptr), m_slot(0) {
+        }
+
+        /**
+            Returns the widget.
+         */
+        reference operator *() const {
+            return m_list->m_slots[m_slot];
+        }
+
+        /**
+            Returns a pointer to the widget.
+         */
+        pointer operator ->() const {
+            return &m_list->m_slots[m_slot];
+        }
+
+        /**
+            Moves to the next widget.
+         */
+        const_iterator &operator ++() {
+            m_slot = m_list->_next(m_slot);
+            return *this;
+        }
+
+        /**
+            Moves to the next widget.
+         */
+        const_iterator operator ++(int) {
+            const_iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        /**
+            Moves to the previous widget.
+         */
+        const_iterator &operator --() {
+            m_slot = m_list->_prev(m_slot);
+            return *this;
+        }
+
+        /**
+            Moves to the previous widget.
+         */
+        const_iterator operator --(int) {
+            const_iterator result = *this;
+            --*this;
+            return result;
+        }
+
+        /**
+            Checks if the iterators point to the same slot.
+            All iterators past the last slot are equal, so as that an end iterator
+            taken before the list was compacted still compares equal to the end.
+         */
+        bool operator == (const const_iterator &it) const {
+            return m_list->_clamp(m_slot) == m_list->_clamp(it.m_slot);
+        }
+
+        /**
+            Checks if the iterators point to different slots.
+         */
+        bool operator != (const const_iterator &it) const {
+            return !operator == (it);
+        }
+
+    private:
+        const WidgetList *m_list;
+        size_t m_slot;
+
+        const_iterator(const WidgetList *list, size_t index) : m_list(list), m_slot(index) {
+        }
+
+        friend class WidgetList;
+    };
+
+    /**
+        The list can not be modified through iterators.
+     */
+    typedef const_iterator iterator;
+
+    /**
+        Reverse iterator.
+     */
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    /**
+        The list can not be modified through iterators.
+     */
+    typedef const_reverse_iterator reverse_iterator;
+
+    /**
+        Value returned by hitTest() when no widget contains the point.
+     */
+    static const size_t npos = (size_t)-1;
+
+    /**
+        The default constructor.
+     */
+    WidgetList() : m_count(0), m_version(0) {
+    }
+
+    /**
+        Returns the number of widgets.
+     */
+    size_t size() const {
+        return m_count;
+    }
+
+    /**
+        Returns true if there are no widgets.
+     */
+    bool empty() const {
+        return m_count == 0;
+    }
+
+    /**
+        Returns the first widget; the list must not be empty.
+     */
+    const WidgetPtr &front() const {
+        return *begin();
+    }
+
+    /**
+        Returns the last widget; the list must not be empty.
+     */
+    const WidgetPtr &back() const {
+        return *--end();
+    }
+
+    /**
+        Returns an iterator to the first widget.
+     */
+    const_iterator begin() const {
+        return const_iterator(this, _next((size_t)-1));
+    }
+
+    /**
+        Returns an iterator past the last widget.
+     */
+    const_iterator end() const {
+        return const_iterator(this, m_slots.size());
+    }
+
+    /**
+        Returns a reverse iterator to the last widget.
+     */
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    /**
+        Returns a reverse iterator before the first widget.
+     */
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    /**
+        Returns an iterator to the given slot.
+     */
+    const_iterator at(size_t slot) const {
+        return const_iterator(this, slot);
+    }
+
+    /**
+        Returns the slot of the first widget after the given slot, or npos if there is none.
+     */
+    size_t getNextSlot(size_t slot) const {
+        slot = _next(slot);
+        return slot < m_slots.size() ? slot : npos;
+    }
+
+    /**
+        Returns the slot of the last widget before the given slot, or npos if there is none.
+     */
+    size_t getPrevSlot(size_t slot) const {
+        while (slot > 0) {
+            if (m_slots[--slot]) return slot;
+        }
+        return npos;
+    }
+
+    /**
+        Returns the widget at the given slot; it is null if the slot is empty.
+     */
+    const WidgetPtr &operator [](size_t slot) const {
+        return m_slots[slot];
+    }
+
+    /**
+        Inserts a widget.
+        Inserting at the end is amortized O(1); inserting elsewhere is O(n).
+        The slots of the widgets are updated.
+        @param slot the widget is inserted before the widget at this slot.
+        @param widget widget to insert.
+     */
+    void insert(size_t slot, const WidgetPtr &widget);
+
+    /**
+        Inserts a widget at the end.
+     */
+    void push_back(const WidgetPtr &widget) {
+        insert(m_slots.size(), widget);
+    }
+
+    /**
+        Removes the widget at the given slot, in O(1) time.
+     */
+    void erase(size_t slot);
+
+    /**
+        Updates the hit-testing data of the widget at the given slot.
+        It must be called when the rectangle or the visibility of the widget changes.
+     */
+    void update(size_t slot);
+
+    /**
+        Finds the topmost visible widget whose rectangle contains the given point,
+        among the widgets before the given slot.
+        Widgets with an extended hit area are found at any point.
+        With SSE2, four widgets are tested per instruction.
+        @param x x coordinate, relative to the parent.
+        @param y y coordinate, relative to the parent.
+        @param before the search starts from the slot before this one.
+        @return the slot of the widget, or npos if there is none.
+     */
+    size_t hitTest(float x, float y, size_t before = npos) const;
+
+    /**
+        Returns true if a visible widget after the given slot overlaps the rectangle of the widget at the slot.
+     */
+    bool isOverlapped(size_t slot) const;
+
+    /**
+        Returns a number which changes whenever a widget is inserted or removed, or its hit-testing data are updated.
+        Useful for caching the results of hit-testing.
+     */
+    size_t getVersion() const {
+        return m_version;
+    }
+
+private:
+    //slots; empty ones are null
+    std::vector<WidgetPtr> m_slots;
+
+    //rectangles of the slots, with exclusive right and bottom; empty for empty slots and invisible widgets
+    std::vector<float> m_left;
+    std::vector<float> m_top;
+    std::vector<float> m_right;
+    std::vector<float> m_bottom;
+
+    //number of widgets
+    size_t m_count;
+
+    //incremented on every change
+    size_t m_version;
+
+    //returns the next non-empty slot after the given one, or the slot count
+    size_t _next(size_t slot) const {
+        for(++slot; slot < m_slots.size() && !m_slots[slot]; ++slot);
+        return slot;
+    }
+
+    //returns the previous non-empty slot before the given one
+    size_t _prev(size_t slot) const {
+        for(--slot; slot > 0 && (slot >= m_slots.size() || !m_slots[slot]); --slot);
+        return slot;
+    }
+
+    //returns the given slot, or the slot count if the slot is past the end
+    size_t _clamp(size_t slot) const {
+        return slot < m_slots.size() ? slot : m_slots.size();
+    }
+
+    //removes the empty slots
+    void _compact();
+
+    //updates the slot of the widgets from the given slot onwards
+    void _updateSlots(size_t first);
+
+    //copies the rectangle of the widget at the given slot to the coordinate arrays
+    void _storeRect(size_t slot);
+};
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_WIDGETLIST_HPP
@@ -0,0 +1,32 @@
+#ifndef AMGUI_BENCHMARK_HPP
+#define AMGUI_BENCHMARK_HPP
+
+
+#include <chrono>
+#include <cstddef>
+
+
+namespace amgui {
+
+
+/**
+    Returns the average time, in milliseconds, an invocation of the given function takes.
+    The function is invoked once more beforehand, so as that first-time costs are not measured.
+    @param iterations number of timed invocations.
+    @param function function to time.
+ */
+template <class F> double measure(size_t iterations, F function) {
+    function();
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i) {
+        function();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+
+} //namespace amgui
+
+
+#endif //AMGUI_BENCHMARK_HPP
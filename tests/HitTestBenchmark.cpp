@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Widget.hpp"
+#include "Benchmark.hpp"
+using namespace amgui;
+
+
+//number of points looked up per measurement
+static const size_t _pointCount = 1000;
+
+
+//finds the child at the given point the way childFromPoint() did before the coordinate arrays,
+//by asking every child from the top down
+static Widget *_childFromPointByIntersects(const Widget *parent, float x, float y) {
+    const WidgetList &children = parent->getChildren();
+    for(auto it = children.rbegin(); it != children.rend(); ++it) {
+        Widget *child = it->get();
+        if (child->isVisible() && child->intersects(x - child->getX(), y - child->getY())) {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+
+int main() {
+    printf("%zu random points per measurement, in microseconds per point\n", _pointCount);
+    printf("%10s %14s %14s %14s\n", "children", "intersects()", "arrays", "spatial index");
+
+    std::mt19937 random(1);
+    for(size_t count : {16, 256, 4096, 65536}) {
+        //a square grid of children, with a gap between them, so as that some points hit none
+        size_t columns = 1;
+        while (columns * columns < count) ++columns;
+        WidgetPtr parent = Widget::create<Widget>();
+        parent->setSize(columns * 10.f, columns * 10.f);
+        for(size_t i = 0; i < count; ++i) {
+            WidgetPtr child = Widget::create<Widget>();
+            child->setRect((i % columns) * 10.f, (i / columns) * 10.f, 8, 8);
+            parent->addChild(child);
+        }
+
+        std::vector<float> points;
+        for(size_t i = 0; i < _pointCount * 2; ++i) {
+            points.push_back(std::uniform_real_distribution<float>(0, columns * 10.f)(random));
+        }
+
+        //the results are compared, so as that the lookups are not optimized away, and the methods agree
+        size_t mismatches = 0;
+        std::vector<Widget *> expected(_pointCount);
+        double before = measure(10, [&]() {
+            for(size_t i = 0; i < _pointCount; ++i) {
+                expected[i] = _childFromPointByIntersects(parent.get(), points[i * 2], points[i * 2 + 1]);
+            }
+        });
+        double after = measure(10, [&]() {
+            for(size_t i = 0; i < _pointCount; ++i) {
+                mismatches += parent->childFromPoint(points[i * 2], points[i * 2 + 1]) != expected[i];
+            }
+        });
+        parent->setSpatialIndex(true, 32);
+        double indexed = measure(10, [&]() {
+            for(size_t i = 0; i < _pointCount; ++i) {
+                mismatches += parent->childFromPoint(points[i * 2], points[i * 2 + 1]) != expected[i];
+            }
+        });
+
+        printf("%10zu %14.4f %14.4f %14.4f\n", count, before * 1000 / _pointCount, after * 1000 / _pointCount, indexed * 1000 / _pointCount);
+        if (mismatches) {
+            printf("%zu lookups found a different child\n", mismatches);
+            return 1;
+        }
+    }
+
+    return 0;
+}
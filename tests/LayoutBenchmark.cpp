@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "FlexBox.hpp"
+#include "GridBox.hpp"
+#include "Benchmark.hpp"
+using namespace amgui;
+
+
+//number of rows of the root box, panels per row, and labels per panel
+static const size_t _rowCount = 50;
+static const size_t _panelCount = 20;
+static const size_t _labelCount = 12;
+
+
+//number of times labels were packed
+static size_t _packCount = 0;
+
+
+//a leaf which needs a size depending on its text, as a label of a real font would
+class Label : public Widget {
+public:
+    void setText(size_t length) {
+        m_length = length;
+        invalidatePack();
+    }
+
+    virtual void pack() override {
+        ++_packCount;
+        setMeasuredSize(m_length * 7.f, 14.f);
+    }
+
+private:
+    size_t m_length = 8;
+};
+
+
+int main() {
+    //a column of rows, each a row of grids of labels
+    std::shared_ptr<FlexBox> root = Widget::create<FlexBox>(FlexBox::Column);
+    root->setSize(1920, 1080);
+    root->setPadding(4);
+    root->setSpacing(2);
+    root->setAlign(AlignStretch);
+    std::vector<std::shared_ptr<Label>> labels;
+    for(size_t i = 0; i < _rowCount; ++i) {
+        std::shared_ptr<FlexBox> row = Widget::create<FlexBox>(FlexBox::Row);
+        row->setSpacing(2);
+        root->addChild(row);
+        root->setGrow(row, 1);
+        for(size_t j = 0; j < _panelCount; ++j) {
+            std::shared_ptr<GridBox> panel = Widget::create<GridBox>(3);
+            panel->setPadding(2);
+            row->addChild(panel);
+            row->setGrow(panel, 1);
+            row->setShrink(panel, 1);
+            for(size_t k = 0; k < _labelCount; ++k) {
+                std::shared_ptr<Label> label = Widget::create<Label>();
+                label->setText(4 + (i + j + k) % 8);
+                panel->addChild(label);
+                labels.push_back(label);
+            }
+        }
+    }
+    size_t nodeCount = 1 + _rowCount + _rowCount * _panelCount + labels.size();
+    printf("%zu nodes: %zu rows of %zu grids of %zu labels\n", nodeCount, _rowCount, _panelCount, _labelCount);
+    printf("%-24s %12s %16s\n", "", "ms/pass", "labels packed");
+
+    //the first pass packs and lays out everything
+    _packCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    root->updateLayout();
+    std::chrono::duration<double, std::milli> first = std::chrono::steady_clock::now() - start;
+    printf("%-24s %12.3f %16zu\n", "first pass", first.count(), _packCount);
+
+    //resizing the root lays everything out again, but the measured sizes are still valid
+    const size_t passes = 100;
+    size_t resizes = 0;
+    _packCount = 0;
+    double time = measure(passes, [&]() {
+        root->setSize(resizes % 2 ? 1920.f : 1600.f, 1080);
+        root->updateLayout();
+        ++resizes;
+    });
+    printf("%-24s %12.3f %16zu\n", "root resize", time, _packCount / (passes + 1));
+
+    //changing a label packs its ancestors, and lays out the parts of the tree whose size changed
+    size_t changes = 0;
+    _packCount = 0;
+    time = measure(passes, [&]() {
+        labels[labels.size() / 2]->setText(changes % 2 ? 8 : 20);
+        root->updateLayout();
+        ++changes;
+    });
+    printf("%-24s %12.3f %16zu\n", "single label change", time, _packCount / (passes + 1));
+
+    //nothing changed
+    _packCount = 0;
+    time = measure(passes, [&]() {
+        root->updateLayout();
+    });
+    printf("%-24s %12.3f %16zu\n", "idle pass", time, _packCount / (passes + 1));
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "FlexBox.hpp"
+#include "Benchmark.hpp"
+using namespace amgui;
+
+
+//number of columns of the root box, and paragraphs per column
+static const size_t _columnCount = 64;
+static const size_t _paragraphCount = 100;
+
+
+//a text which breaks into lines when laid out, as a text view of a real font would
+class Paragraph : public Widget {
+public:
+    Paragraph(size_t seed) : m_text(600, ' '), m_lines(0) {
+        for(size_t i = 0; i < m_text.size(); ++i) {
+            m_text[i] = (i * 7 + seed) % 9 == 0 ? ' ' : (char)('a' + (i + seed) % 26);
+        }
+    }
+
+    size_t getLines() const {
+        return m_lines;
+    }
+
+    virtual void pack() override {
+        setMeasuredSize(100, 40);
+    }
+
+    //breaks the text at spaces into lines that fit the width
+    virtual void layout() override {
+        m_lines = 1;
+        float x = 0, wordWidth = 0;
+        for(char c : m_text) {
+            float width = 5.f + (c % 4);
+            if (c == ' ') {
+                if (x + wordWidth > getWidth()) {
+                    ++m_lines;
+                    x = 0;
+                }
+                x += wordWidth + width;
+                wordWidth = 0;
+            }
+            else {
+                wordWidth += width;
+            }
+        }
+        Widget::layout();
+    }
+
+private:
+    std::string m_text;
+    size_t m_lines;
+};
+
+
+int main() {
+    //a row of columns of paragraphs, which are all laid out again when the width of the root changes
+    std::shared_ptr<FlexBox> root = Widget::create<FlexBox>(FlexBox::Row);
+    root->setSize(1920, 1080);
+    root->setAlign(AlignStretch);
+    std::vector<std::shared_ptr<Paragraph>> paragraphs;
+    for(size_t i = 0; i < _columnCount; ++i) {
+        std::shared_ptr<FlexBox> column = Widget::create<FlexBox>(FlexBox::Column);
+        column->setAlign(AlignStretch);
+        root->addChild(column);
+        root->setGrow(column, 1);
+        root->setShrink(column, 1);
+        for(size_t j = 0; j < _paragraphCount; ++j) {
+            std::shared_ptr<Paragraph> paragraph = Widget::create<Paragraph>(i * _paragraphCount + j);
+            column->addChild(paragraph);
+            paragraphs.push_back(paragraph);
+        }
+    }
+    root->updateLayout();
+
+    size_t maxThreads = ThreadPool::getDefaultThreadCount() + 1;
+    printf("%zu columns of %zu paragraphs, all laid out again on each pass\n", _columnCount, _paragraphCount);
+    printf("%-16s %12s %10s\n", "worker threads", "ms/pass", "speedup");
+
+    //the serial layout first, then pools of more and more workers, which the calling thread helps
+    double serial = 0;
+    size_t lines = 0;
+    for(size_t threads = 0; threads < std::max<size_t>(maxThreads, 2); ++threads) {
+        Widget::setLayoutThreadPool(threads ? std::make_shared<ThreadPool>(threads) : nullptr);
+        size_t resizes = 0;
+        double time = measure(20, [&]() {
+            root->setSize(resizes % 2 ? 1920.f : 1280.f, 1080);
+            root->updateLayout();
+            ++resizes;
+        });
+        if (!threads) {
+            serial = time;
+        }
+        //std::to_string is not available with mingw 4.7
+        char name[32] = "none";
+        if (threads) {
+            snprintf(name, sizeof(name), "%zu", threads);
+        }
+        printf("%-16s %12.3f %9.2fx\n", name, time, serial / time);
+
+        //every layout must break the text the same way
+        size_t sum = 0;
+        for(const std::shared_ptr<Paragraph> &paragraph : paragraphs) {
+            sum += paragraph->getLines();
+        }
+        if (threads && sum != lines) {
+            printf("the parallel layout broke %zu lines instead of %zu\n", sum, lines);
+            return 1;
+        }
+        lines = sum;
+    }
+
+    Widget::setLayoutThreadPool(nullptr);
+    return 0;
+}
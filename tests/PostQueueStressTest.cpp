@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <vector>
+#include <functional>
+#include "PostQueue.hpp"
+using namespace amgui;
+
+
+//number of threads posting at the same time
+static const size_t _producerCount = 8;
+
+
+//number of functions each thread posts
+static const size_t _postCount = 200000;
+
+
+//runs the function an allegro thread is created with
+static void *_run(ALLEGRO_THREAD *thread, void *arg) {
+    (*static_cast<std::function<void()> *>(arg))();
+    return nullptr;
+}
+
+
+int main() {
+    al_init();
+
+    PostQueue queue;
+
+    //the functions are invoked by this thread only, so the counters need no synchronization;
+    //each function checks that it is the next one of its producer, which catches lost, duplicated and reordered functions
+    std::vector<size_t> next(_producerCount, 0);
+    size_t errors = 0;
+
+    std::vector<std::function<void()>> functions(_producerCount);
+    std::vector<ALLEGRO_THREAD *> producers;
+    for(size_t producer = 0; producer < _producerCount; ++producer) {
+        functions[producer] = [&, producer]() {
+            for(size_t i = 0; i < _postCount; ++i) {
+                queue.post([&, producer, i]() {
+                    if (i != next[producer]) {
+                        if (errors++ < 10) {
+                            printf("producer %zu: function %zu invoked when %zu was expected\n", producer, i, next[producer]);
+                        }
+                    }
+                    next[producer] = i + 1;
+                });
+            }
+        };
+        producers.push_back(al_create_thread(&_run, &functions[producer]));
+        al_start_thread(producers.back());
+    }
+
+    //invoke the functions while they are posted, then the rest
+    size_t invoked = 0;
+    while (invoked < _producerCount * _postCount) {
+        size_t count = queue.invoke();
+        if (count == 0) {
+            al_rest(0);
+        }
+        invoked += count;
+    }
+    for(ALLEGRO_THREAD *producer : producers) {
+        al_join_thread(producer, nullptr);
+        al_destroy_thread(producer);
+    }
+    invoked += queue.invoke();
+
+    for(size_t producer = 0; producer < _producerCount; ++producer) {
+        if (next[producer] != _postCount) {
+            printf("producer %zu: %zu of %zu functions invoked\n", producer, next[producer], _postCount);
+            ++errors;
+        }
+    }
+    if (invoked != _producerCount * _postCount) {
+        printf("%zu functions invoked instead of %zu\n", invoked, _producerCount * _postCount);
+        ++errors;
+    }
+
+    printf("%zu threads, %zu functions each: %s\n", _producerCount, _postCount, errors ? "failed" : "ok");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_primitives.h"
+#include "Widget.hpp"
+#include "Benchmark.hpp"
+using namespace amgui;
+
+
+//if false, the boxes call the primitives addon directly, as widgets did before the batch
+static bool _batched = true;
+
+
+//number of calls to the primitives addon made by the boxes themselves
+static size_t _directCalls = 0;
+
+
+//a filled rectangle with an outline, like the demo widget
+class Box : public Widget {
+public:
+    virtual void draw(float px, float py, bool enabled, bool highlighted, bool pushed, bool selected) {
+        float x1 = px + getX(), y1 = py + getY(), x2 = x1 + getWidth(), y2 = y1 + getHeight();
+        if (_batched) {
+            PrimitiveBatch *batch = PrimitiveBatch::getCurrent();
+            batch->drawFilledRectangle(x1, y1, x2, y2, al_map_rgb(255, 255, 255));
+            batch->drawRectangle(x1, y1, x2, y2, al_map_rgb(0, 0, 0), 1);
+        }
+        else {
+            al_draw_filled_rectangle(x1, y1, x2, y2, al_map_rgb(255, 255, 255));
+            al_draw_rectangle(x1, y1, x2, y2, al_map_rgb(0, 0, 0), 1);
+            _directCalls += 2;
+        }
+        Widget::draw(px, py, enabled, highlighted, pushed, selected);
+    }
+};
+
+
+int main() {
+    al_init();
+    al_init_primitives_addon();
+
+    //vsync would hide the difference
+    al_set_new_display_option(ALLEGRO_VSYNC, 2, ALLEGRO_SUGGEST);
+    ALLEGRO_DISPLAY *display = al_create_display(800, 600);
+    if (!display) {
+        printf("the display cannot be created\n");
+        return 1;
+    }
+
+    //100 panels of 100 boxes, all of them visible
+    WidgetPtr root = Widget::create<Box>();
+    root->setSize(800, 600);
+    for(int i = 0; i < 100; ++i) {
+        WidgetPtr panel = Widget::create<Box>();
+        panel->setRect((i % 10) * 80.f, (i / 10) * 60.f, 80, 60);
+        root->addChild(panel);
+        for(int j = 0; j < 100; ++j) {
+            WidgetPtr box = Widget::create<Box>();
+            box->setRect((j % 10) * 8.f, (j / 10) * 6.f, 8, 6);
+            panel->addChild(box);
+        }
+    }
+    root->updateLayout();
+
+    PrimitiveBatch batch;
+    batch.begin();
+
+    printf("10101 boxes, a filled rectangle and an outline each\n");
+    const size_t frames = 100;
+    for(int mode = 0; mode < 2; ++mode) {
+        _batched = mode == 1;
+        _directCalls = 0;
+        batch.resetStatistics();
+        double time = measure(frames, [&]() {
+            al_clear_to_color(al_map_rgb(128, 128, 128));
+            root->draw();
+            al_flip_display();
+        });
+        size_t calls = (_batched ? batch.getDrawCallCount() : _directCalls) / (frames + 1);
+        printf("%-10s %10.3f ms/frame %10zu draw calls/frame\n", _batched ? "batched" : "direct", time, calls);
+    }
+
+    batch.end();
+    root.reset();
+    al_destroy_display(display);
+    return 0;
+}
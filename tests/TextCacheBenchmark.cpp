@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "allegro5/allegro.h"
+#include "allegro5/allegro_font.h"
+#include "allegro5/allegro_ttf.h"
+#include "TextCache.hpp"
+#include "PrimitiveBatch.hpp"
+#include "Benchmark.hpp"
+using namespace amgui;
+
+
+//number of labels drawn per frame
+static const size_t _labelCount = 5000;
+
+
+int main() {
+    al_init();
+    al_init_font_addon();
+    al_init_ttf_addon();
+
+    //vsync would hide the difference
+    al_set_new_display_option(ALLEGRO_VSYNC, 2, ALLEGRO_SUGGEST);
+    ALLEGRO_DISPLAY *display = al_create_display(1280, 720);
+    if (!display) {
+        printf("the display cannot be created\n");
+        return 1;
+    }
+
+    //the font of the test program
+    std::shared_ptr<ALLEGRO_FONT> font(al_load_font("../myfont.ttf", 12, 0), al_destroy_font);
+    if (!font) {
+        printf("../myfont.ttf cannot be loaded\n");
+        return 1;
+    }
+
+    //labels of different texts, in a grid which covers the display
+    std::vector<std::string> texts;
+    //std::to_string is not available with mingw 4.7
+    for(size_t i = 0; i < _labelCount; ++i) {
+        char text[32];
+        snprintf(text, sizeof(text), "Label %zu", i);
+        texts.push_back(text);
+    }
+    const size_t columns = 20;
+    const float columnWidth = 64, rowHeight = 720.f / (_labelCount / columns);
+
+    PrimitiveBatch batch;
+    batch.begin();
+    TextCache cache;
+
+    printf("%zu labels per frame\n", _labelCount);
+    const size_t frames = 50;
+    for(int mode = 0; mode < 2; ++mode) {
+        const bool cached = mode == 1;
+        batch.resetStatistics();
+        double time = measure(frames, [&]() {
+            al_clear_to_color(al_map_rgb(255, 255, 255));
+            for(size_t i = 0; i < _labelCount; ++i) {
+                float x = (i % columns) * columnWidth, y = (i / columns) * rowHeight;
+                if (cached) {
+                    cache.draw(font, al_map_rgb(0, 0, 0), x, y, 0, texts[i]);
+                }
+                else {
+                    al_draw_text(font.get(), al_map_rgb(0, 0, 0), x, y, 0, texts[i].c_str());
+                }
+            }
+            batch.flush();
+            al_flip_display();
+        });
+        if (cached) {
+            printf("%-14s %10.3f ms/frame %10zu draw calls/frame, %zu pages, %zu KB\n", "TextCache", time, batch.getDrawCallCount() / (frames + 1), cache.getPageCount(), cache.getMemory() / 1024);
+        }
+        else {
+            printf("%-14s %10.3f ms/frame %10zu draw calls/frame\n", "al_draw_text", time, _labelCount);
+        }
+    }
+
+    cache.clear();
+    batch.end();
+    font.reset();
+    al_destroy_display(display);
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <cstdio>
+#include <list>
+#include <vector>
+#include "Widget.hpp"
+#include "Benchmark.hpp"
+using namespace amgui;
+
+
+//number of children of the container
+static const size_t _childCount = 100000;
+
+
+//a widget as children were stored before: in a std::list, with a weak parent pointer and an iterator into the parent's list
+class ListWidget : public std::enable_shared_from_this<ListWidget> {
+public:
+    typedef std::shared_ptr<ListWidget> Ptr;
+
+    float x = 0, y = 0, width = 1, height = 1;
+    std::list<Ptr> children;
+
+    void addChild(const Ptr &child) {
+        child->m_parent = shared_from_this();
+        child->m_it = children.insert(children.end(), child);
+    }
+
+    Ptr getFirstChild() const {
+        return children.empty() ? Ptr() : children.front();
+    }
+
+    //the previous implementation of Widget::getNextSibling()
+    Ptr getNextSibling() const {
+        Ptr parent = m_parent.lock();
+        if (parent) {
+            auto it = m_it;
+            ++it;
+            return it != parent->children.end() ? *it : Ptr();
+        }
+        return Ptr();
+    }
+
+private:
+    std::weak_ptr<ListWidget> m_parent;
+    std::list<Ptr>::iterator m_it;
+};
+
+
+int main() {
+    //the children, in a widget and in a list widget, as children were stored before
+    WidgetPtr root = Widget::create<Widget>();
+    ListWidget::Ptr listRoot = std::make_shared<ListWidget>();
+    for(size_t i = 0; i < _childCount; ++i) {
+        WidgetPtr child = Widget::create<Widget>();
+        child->setRect((float)(i % 1000), (float)(i / 1000), 1, 1);
+        root->addChild(child);
+        ListWidget::Ptr listChild = std::make_shared<ListWidget>();
+        listChild->x = child->getX();
+        listChild->y = child->getY();
+        listRoot->addChild(listChild);
+    }
+
+    printf("%zu children\n", _childCount);
+    printf("%-28s %12s %12s\n", "", "std::list", "WidgetList");
+
+    float sum = 0;
+    double before = measure(100, [&]() {
+        for(const ListWidget::Ptr &child : listRoot->children) {
+            sum += child->x;
+        }
+    });
+    double after = measure(100, [&]() {
+        for(const WidgetPtr &child : root->getChildren()) {
+            sum += child->getX();
+        }
+    });
+    printf("%-28s %9.3f ms %9.3f ms\n", "forward traversal", before, after);
+
+    before = measure(100, [&]() {
+        for(auto it = listRoot->children.rbegin(); it != listRoot->children.rend(); ++it) {
+            sum += (*it)->y;
+        }
+    });
+    after = measure(100, [&]() {
+        for(auto it = root->getChildren().rbegin(); it != root->getChildren().rend(); ++it) {
+            sum += (*it)->getY();
+        }
+    });
+    printf("%-28s %9.3f ms %9.3f ms\n", "reverse traversal", before, after);
+
+    before = measure(10, [&]() {
+        for(ListWidget::Ptr child = listRoot->getFirstChild(); child; child = child->getNextSibling()) {
+            sum += child->width;
+        }
+    });
+    after = measure(10, [&]() {
+        for(WidgetPtr child = root->getFirstChild(); child; child = child->getNextSibling()) {
+            sum += child->getWidth();
+        }
+    });
+    printf("%-28s %9.3f ms %9.3f ms\n", "next sibling navigation", before, after);
+
+    //the sum is used, so as that the traversals are not optimized away
+    return sum < 0;
+}